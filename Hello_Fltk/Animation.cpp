@@ -0,0 +1,202 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Animation.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <FL/Fl.H>
+
+namespace mathsophy::graphics
+{
+
+// progress 0 to 1 of a tween at time t (0 to 1)
+double ease(Easing_type e, double t)
+{
+    t = clamp(t,0.0,1.0);
+    switch (e) {
+        case Easing_type::linear:      return t;
+        case Easing_type::ease_in:     return t*t;
+        case Easing_type::ease_out:    return t*(2-t);
+        case Easing_type::ease_in_out: return t*t*(3-2*t);
+    }
+    return t;
+}
+
+//
+// Animator statistics
+//
+
+ostream& operator<<(ostream& os, const Animator_stats& s)
+{
+    return os << s.frames << " frames, " << s.dropped << " dropped, "
+              << s.redraws << " redraws, tick " << s.mean_tick()*1e3
+              << " ms mean, " << s.max_tick*1e3 << " ms max";
+}
+
+//
+// Animator
+//
+
+// constructor
+Animator::Animator(double fps) : period{fps > 0 ? 1/fps : 1/60.0}
+{
+}
+
+// virtual destructor, the tweens are stopped where they are
+Animator::~Animator()
+{
+    Fl::remove_timeout(timeout,this);
+}
+
+// tweens starting now and lasting the given seconds
+size_t Animator::move_to(Shape& s, Point to, double seconds, Easing_type e, function<void()> done)
+{
+    Point from = s.get_tl();
+    return add(s,seconds,e,[&s,from,to](double p) {
+        Point q{from.x+int(lround((to.x-from.x)*p)),from.y+int(lround((to.y-from.y)*p))};
+        if ( (q.x != s.get_tl().x) || (q.y != s.get_tl().y) )
+            s.move(q.x-s.get_tl().x,q.y-s.get_tl().y);
+    },move(done));
+}
+
+size_t Animator::color_to(Shape& s, Fl_Color to, double seconds, Easing_type e, function<void()> done)
+{
+    uchar r0, g0, b0, r1, g1, b1;
+    Fl::get_color(to_fl_color(s.get_color()),r0,g0,b0);
+    Fl::get_color(to,r1,g1,b1);
+    return add(s,seconds,e,[&s,to,r0,g0,b0,r1,g1,b1](double p) {
+        auto mix = [p](uchar a, uchar b) { return uchar(lround(a+(b-a)*p)); };
+        if (p >= 1) s.set_color(int(to));
+        else s.set_color(int(fl_rgb_color(mix(r0,r1),mix(g0,g1),mix(b0,b1))));
+    },move(done));
+}
+
+size_t Animator::alpha_to(Widget& w, int to, double seconds, Easing_type e, function<void()> done)
+{
+    int from = w.get_alpha();
+    return add(w,seconds,e,[&w,from,to](double p) {
+        w.set_alpha(int(lround(from+(to-from)*p)));
+    },move(done));
+}
+
+// any property: set(v) with v from v0 to v1
+size_t Animator::tween(Widget& w, double v0, double v1, double seconds,
+                       function<void(double)> set, Easing_type e, function<void()> done)
+{
+    return add(w,seconds,e,[set,v0,v1](double p) { set(v0+(v1-v0)*p); },move(done));
+}
+
+// stop a tween where it is
+void Animator::cancel(size_t id)
+{
+    // a tick may be running the tweens, so the
+    // tween is only marked and erased by the next one
+    for (auto& t : tweens)
+        if (t.id == id) t.w = nullptr;
+}
+
+// runs the FLTK loop until all the tweens have ended
+void Animator::wait()
+{
+    while ( is_running() ) Fl::wait();
+}
+
+// helper methods
+size_t Animator::add(Widget& w, double seconds, Easing_type e,
+                     function<void(double)> set, function<void()> done)
+{
+    tweens.push_back(Tween{next_id,&w,clock::now(),seconds,e,move(set),move(done)});
+    if (!ticking)
+    {
+        deadline = clock::now() + chrono::duration_cast<clock::duration>(chrono::duration<double>(period));
+        Fl::add_timeout(period,timeout,this);
+        ticking = true;
+    }
+    return next_id++;
+}
+
+void Animator::tick()
+{
+    ticking = false;
+    clock::time_point now = clock::now();
+    // the frames missed by a late tick are skipped
+    auto p = chrono::duration_cast<clock::duration>(chrono::duration<double>(period));
+    size_t missed = (now > deadline) ? size_t((now-deadline)/p) : 0;
+    stats.dropped += missed;
+    deadline += p*(missed+1);
+    // every tween at its value of now
+    vector<Fl_Window*> windows;
+    vector< function<void()> > finished;
+    for (size_t i=0; i < tweens.size(); )
+    {
+        Tween& t = tweens[i];
+        if (!t.w)
+        {
+            tweens.erase(tweens.begin()+i);
+            continue;
+        }
+        double elapsed = chrono::duration<double>(now-t.start).count();
+        double f = (t.seconds > 0) ? min(elapsed/t.seconds,1.0) : 1.0;
+        t.set(ease(t.e,f));
+        if (Fl_Window* win = t.w->window())
+            if (find(windows.begin(),windows.end(),win) == windows.end())
+                windows.push_back(win);
+        if (f >= 1)
+        {
+            if (t.done) finished.push_back(move(t.done));
+            tweens.erase(tweens.begin()+i);
+        }
+        else i++;
+    }
+    // one redraw per window, Widget::redraw() would run the loop
+    for (auto win : windows) win->redraw();
+    stats.redraws += windows.size();
+    stats.frames++;
+    double d = chrono::duration<double>(clock::now()-now).count();
+    stats.total_tick += d;
+    stats.max_tick = max(stats.max_tick,d);
+    if ( !tweens.empty() )
+    {
+        Fl::add_timeout(max(0.0,chrono::duration<double>(deadline-clock::now()).count()),timeout,this);
+        ticking = true;
+    }
+    // the callbacks may start new tweens
+    for (auto& f : finished) f();
+}
+
+void Animator::timeout(void* a)
+{
+    static_cast<Animator*>(a)->tick();
+}
+
+} // namespace mathsophy::graphics
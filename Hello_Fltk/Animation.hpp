@@ -0,0 +1,144 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Animation.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Animation_hpp
+#define Animation_hpp
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "Graphics.hpp"
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// easing enumerations
+//
+
+enum class Easing_type
+{
+    linear,       // constant speed
+    ease_in,      // starts slowly
+    ease_out,     // ends slowly
+    ease_in_out   // starts and ends slowly
+};
+
+// progress 0 to 1 of a tween at time t (0 to 1)
+double ease(Easing_type e, double t);
+
+//
+// Animator statistics
+//
+
+struct Animator_stats
+{
+    size_t frames{0};       // ticks which updated the shapes
+    size_t dropped{0};      // ticks skipped, the previous one was late
+    size_t redraws{0};      // windows redrawn, one per tick at most
+    double max_tick{0};     // longest tick in seconds
+    double total_tick{0};   // time spent in the ticks in seconds
+    double mean_tick() const { return frames ? total_tick/frames : 0; }
+};
+
+ostream& operator<<(ostream& os, const Animator_stats& s);
+
+//
+// Animator
+//
+
+// runs tweens (changes of a property of a widget over time) with
+// Fl::add_timeout at a target frame rate: every tick sets all the
+// tweens to their value at the current time and redraws each window
+// once; a tick coming late skips the frames it missed instead of
+// catching up, the tweens stay on time and the skips are counted
+class Animator
+{
+public:
+    // constructor
+    Animator(double fps = 60);
+    // no copy constructor allowed
+    Animator(const Animator&) = delete;
+    // no copy assignment allowed
+    Animator& operator=(const Animator&) = delete;
+    // virtual destructor, the tweens are stopped where they are
+    virtual ~Animator();
+    // tweens starting now and lasting the given seconds, they return
+    // an id for cancel(); done is called once the tween has ended
+    size_t move_to(Shape& s, Point to, double seconds,
+                   Easing_type e = Easing_type::linear, function<void()> done = nullptr);
+    size_t color_to(Shape& s, Fl_Color to, double seconds,
+                    Easing_type e = Easing_type::linear, function<void()> done = nullptr);
+    size_t alpha_to(Widget& w, int to, double seconds,
+                    Easing_type e = Easing_type::linear, function<void()> done = nullptr);
+    // any property: set(v) with v from v0 to v1
+    size_t tween(Widget& w, double v0, double v1, double seconds,
+                 function<void(double)> set, Easing_type e = Easing_type::linear,
+                 function<void()> done = nullptr);
+    // stop a tween where it is
+    void cancel(size_t id);
+    // true while tweens are running
+    bool is_running() const { return !tweens.empty(); }
+    // runs the FLTK loop until all the tweens have ended
+    void wait();
+    // getter methods
+    double get_fps() const { return 1/period; }
+    Animator_stats get_stats() const { return stats; }
+private:
+    using clock = chrono::steady_clock;
+    struct Tween
+    {
+        size_t id;
+        Widget* w;
+        clock::time_point start;
+        double seconds;
+        Easing_type e;
+        function<void(double)> set;  // called with the progress 0 to 1
+        function<void()> done;
+    };
+    vector<Tween> tweens;
+    size_t next_id{1};
+    double period;                   // seconds between ticks
+    clock::time_point deadline{};    // time of the next tick
+    bool ticking{false};             // timeout pending
+    Animator_stats stats;
+    size_t add(Widget& w, double seconds, Easing_type e,
+               function<void(double)> set, function<void()> done);
+    void tick();
+    static void timeout(void* a);
+};
+
+}
+#endif /* Animation_hpp */
@@ -0,0 +1,218 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Counters.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Counters.hpp"
+#include "Graphics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace mathsophy::graphics
+{
+
+// name of a counter, as printed
+const char* counter_name(Counter_type t)
+{
+    static const char* names[nb_counters] = {
+        "resize scans", "resize points", "text extents", "point allocs", "hide/show",
+        "draw calls"
+    };
+    return (size_t(t) < nb_counters) ? names[size_t(t)] : "";
+}
+
+//
+// Counters
+//
+
+// the counters of the process
+Counters& Counters::instance()
+{
+    static Counters counters;
+    return counters;
+}
+
+// count n units of work of type t done for widget w
+void Counters::add(Counter_type t, const Widget* w, uint64_t n)
+{
+    if (in_frame)
+    {
+        in_frame->frame[t] += n;
+        in_frame->total[t] += n;
+        return;
+    }
+    if (w && w->get_win())
+        get(w->get_win()).total[t] += n;
+    else if (w)
+        pending[w][t] += n;
+    else
+        get(nullptr).total[t] += n;
+}
+
+// widget w attached to window win, its work so far goes there
+void Counters::attach(const Widget* w, const Fl_Window* win)
+{
+    auto i = pending.find(w);
+    if (i == pending.end())
+        return;
+    Window_counters& c = get(win);
+    if (win && win->label()) c.label = win->label();
+    for (size_t k=0; k < nb_counters; k++)
+        c.total.v[k] += i->second.v[k];
+    pending.erase(i);
+}
+
+// widget w or window w destroyed
+void Counters::remove(const Widget* w)
+{
+    auto i = pending.find(w);
+    if (i == pending.end())
+        return;
+    Window_counters& c = get(nullptr);
+    for (size_t k=0; k < nb_counters; k++)
+        c.total.v[k] += i->second.v[k];
+    pending.erase(i);
+}
+
+void Counters::remove(const Fl_Window* w)
+{
+    // the counts stay in windows for print()
+    open.erase(w);
+}
+
+// frame of window w, called by its draw()
+void Counters::begin_frame(const Fl_Window* w)
+{
+    in_frame = &get(w);
+    in_frame->frame = Counter_values{};
+    if (w && w->label()) in_frame->label = w->label();
+}
+
+void Counters::end_frame(const Fl_Window* w)
+{
+    Window_counters& c = get(w);
+    c.frames++;
+    c.last_frame = c.frame;
+    for (size_t i=0; i < nb_counters; i++)
+        c.max_frame.v[i] = max(c.max_frame.v[i],c.frame.v[i]);
+    in_frame = nullptr;
+}
+
+// getter methods
+Counter_values Counters::get_total() const
+{
+    Counter_values s;
+    for (auto& w : windows)
+        for (size_t i=0; i < nb_counters; i++)
+            s.v[i] += w.total.v[i];
+    for (auto& w : pending)
+        for (size_t i=0; i < nb_counters; i++)
+            s.v[i] += w.second.v[i];
+    return s;
+}
+
+Counter_values Counters::get_total(const Fl_Window* w) const
+{
+    const Window_counters* c = find(w);
+    return c ? c->total : Counter_values{};
+}
+
+Counter_values Counters::get_last_frame(const Fl_Window* w) const
+{
+    const Window_counters* c = find(w);
+    return c ? c->last_frame : Counter_values{};
+}
+
+Counter_values Counters::get_max_frame(const Fl_Window* w) const
+{
+    const Window_counters* c = find(w);
+    return c ? c->max_frame : Counter_values{};
+}
+
+uint64_t Counters::get_frames(const Fl_Window* w) const
+{
+    const Window_counters* c = find(w);
+    return c ? c->frames : 0;
+}
+
+// forget all the counts
+void Counters::clear()
+{
+    windows.clear();
+    open.clear();
+    pending.clear();
+    in_frame = nullptr;
+    no_window = nullptr;
+}
+
+// one line per window and counter: total and maximum per frame
+void Counters::print(ostream& os) const
+{
+    for (auto& c : windows)
+    {
+        os << (c.window ? (c.label.empty() ? string{"(untitled)"} : c.label) : string{"(no window)"})
+           << ": " << c.frames << " frames\n";
+        for (size_t i=0; i < nb_counters; i++)
+        {
+            if (c.total.v[i] == 0) continue;
+            os << "    " << left << setw(14) << counter_name(Counter_type(i)) << right
+               << setw(10) << c.total.v[i] << " total";
+            if (c.frames) os << setw(10) << c.max_frame.v[i] << " max per frame";
+            os << '\n';
+        }
+    }
+}
+
+// helper methods
+Counters::Window_counters& Counters::get(const Fl_Window* w)
+{
+    if (!w)
+    {
+        if (!no_window) no_window = &windows.emplace_back();
+        return *no_window;
+    }
+    Window_counters*& c = open[w];
+    if (!c)
+    {
+        c = &windows.emplace_back();
+        c->window = true;
+    }
+    return *c;
+}
+
+const Counters::Window_counters* Counters::find(const Fl_Window* w) const
+{
+    if (!w)
+        return no_window;
+    auto i = open.find(w);
+    return (i == open.end()) ? nullptr : i->second;
+}
+
+} // namespace mathsophy::graphics
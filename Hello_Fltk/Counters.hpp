@@ -0,0 +1,156 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Counters.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Counters_hpp
+#define Counters_hpp
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <FL/Fl_Window.H>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+class Widget;
+
+//
+// counter enumerations
+//
+
+enum class Counter_type
+{
+    resize_scans,    // full rescans of the points of a shape by resize_widget()
+    resize_points,   // points visited by these rescans
+    text_extents,    // calls of fl_text_extents()
+    point_allocs,    // allocations of point and line storage
+    hide_show,       // hide() and show() around a setter or a move
+    draw_calls,      // lines and paths sent to the graphics backend
+    nb_counters
+};
+
+const size_t nb_counters = size_t(Counter_type::nb_counters);
+
+// name of a counter, as printed
+const char* counter_name(Counter_type t);
+
+//
+// Counter values
+//
+
+struct Counter_values
+{
+    array<uint64_t, nb_counters> v{};
+    uint64_t operator[](Counter_type t) const { return v[size_t(t)]; }
+    uint64_t& operator[](Counter_type t) { return v[size_t(t)]; }
+};
+
+//
+// Counters
+//
+
+// the hidden work of the library counted per window and per frame
+// (one draw of a window); the work done outside a frame goes to the
+// window the widget is attached to, the work done before is kept
+// for the widget until it is attached, or goes to no window if the
+// widget is destroyed first; a destroyed window keeps its counts
+// but a new window at the same address starts from zero; off by
+// default, when off a count costs one test of a flag;
+// used by the UI thread only
+class Counters
+{
+public:
+    // the counters of the process
+    static Counters& instance();
+    // no copy constructor allowed
+    Counters(const Counters&) = delete;
+    // no copy assignment allowed
+    Counters& operator=(const Counters&) = delete;
+    // setter and getter methods for the runtime switch
+    static void enable(bool on) { enabled = on; }
+    static bool is_enabled() { return enabled; }
+    // count n units of work of type t done for widget w
+    void add(Counter_type t, const Widget* w, uint64_t n = 1);
+    // widget w attached to window win, its work so far goes there
+    void attach(const Widget* w, const Fl_Window* win);
+    // widget w or window w destroyed
+    void remove(const Widget* w);
+    void remove(const Fl_Window* w);
+    // frame of window w, called by its draw()
+    void begin_frame(const Fl_Window* w);
+    void end_frame(const Fl_Window* w);
+    // getter methods: all the windows, or one window in total,
+    // during its last frame, at most during one frame
+    Counter_values get_total() const;
+    Counter_values get_total(const Fl_Window* w) const;
+    Counter_values get_last_frame(const Fl_Window* w) const;
+    Counter_values get_max_frame(const Fl_Window* w) const;
+    uint64_t get_frames(const Fl_Window* w) const;
+    // forget all the counts
+    void clear();
+    // one line per window and counter: total and maximum per frame
+    void print(ostream& os) const;
+private:
+    Counters() {}
+    struct Window_counters
+    {
+        bool window{false};           // false for the work of no window
+        string label;                 // title of the window
+        uint64_t frames{0};           // draws of the window
+        Counter_values total;         // since the start
+        Counter_values frame;         // in the current frame
+        Counter_values last_frame;    // in the last frame
+        Counter_values max_frame;     // most in one frame
+    };
+    inline static bool enabled{false};
+    deque<Window_counters> windows;                 // in order of the first count
+    map<const Fl_Window*, Window_counters*> open;   // windows not destroyed yet
+    map<const Widget*, Counter_values> pending;     // widgets not attached yet
+    Window_counters* in_frame{nullptr};             // window being drawn
+    Window_counters* no_window{nullptr};            // work of no window
+    Window_counters& get(const Fl_Window* w);
+    const Window_counters* find(const Fl_Window* w) const;
+};
+
+// count n units of work of type t done for widget w
+inline void count_work(Counter_type t, const Widget* w, uint64_t n = 1)
+{
+    if (Counters::is_enabled()) Counters::instance().add(t,w,n);
+}
+
+}
+#endif /* Counters_hpp */
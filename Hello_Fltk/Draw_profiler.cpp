@@ -0,0 +1,236 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Draw_profiler.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Draw_profiler.hpp"
+#include "Graphics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <typeinfo>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+// readable class name of a widget
+string class_name(const Widget* w)
+{
+    const char* n = typeid(*w).name();
+#if defined(__GNUC__)
+    int status = 0;
+    char* d = abi::__cxa_demangle(n,nullptr,nullptr,&status);
+    if (d)
+    {
+        string s{d};
+        free(d);
+        // without the namespace
+        size_t i = s.rfind("::");
+        return (i == string::npos) ? s : s.substr(i+2);
+    }
+#endif
+    return n;
+}
+
+const char* kind_names[2] = {"draw","redraw"};
+
+}
+
+//
+// Latency histogram
+//
+
+void Latency_histogram::add(uint64_t ns)
+{
+    int i;
+    if (ns < 16) i = int(ns);
+    else
+    {
+        // exponent and the 3 bits which follow the leading one
+        int e = 63 - __builtin_clzll(ns);
+        i = 16 + (e-4)*8 + int((ns >> (e-3)) & 7);
+    }
+    buckets[min(i,nb_buckets-1)]++;
+    count++;
+    total += ns;
+    max_ns = max(max_ns,ns);
+}
+
+// the duration below which a fraction q (0 to 1) of the samples are
+uint64_t Latency_histogram::percentile(double q) const
+{
+    if (count == 0) return 0;
+    uint64_t rank = max<uint64_t>(1,uint64_t(ceil(q*count)));
+    uint64_t n = 0;
+    for (int i=0; i < nb_buckets; i++)
+    {
+        n += buckets[i];
+        if (n < rank) continue;
+        if (i < 16) return uint64_t(i);
+        // upper end of the bucket, never above the maximum
+        int e = 4 + (i-16)/8;
+        uint64_t upper = (uint64_t(8 + (i-16)%8 + 1) << (e-3)) - 1;
+        return min(upper,max_ns);
+    }
+    return max_ns;
+}
+
+//
+// Draw profiler
+//
+
+// the profiler of the process
+Draw_profiler& Draw_profiler::instance()
+{
+    static Draw_profiler profiler;
+    return profiler;
+}
+
+// add a duration of widget w
+void Draw_profiler::record(const Widget* w, Draw_kind k, chrono::steady_clock::duration d)
+{
+    uint64_t ns = uint64_t(chrono::duration_cast<chrono::nanoseconds>(d).count());
+    type_index t{typeid(*w)};
+    Entry& e = widgets[w];
+    // first draw, or a widget at the address of a deleted one
+    if (e.type != t)
+    {
+        e = Entry{};
+        e.type = t;
+        e.x = w->get_tl().x;
+        e.y = w->get_tl().y;
+        e.width = w->get_w();
+        e.height = w->get_h();
+    }
+    e.h[int(k)].add(ns);
+    auto c = classes.find(t);
+    if (c == classes.end())
+    {
+        c = classes.emplace(t,Entry{}).first;
+        c->second.type = t;
+        c->second.name = class_name(w);
+    }
+    c->second.h[int(k)].add(ns);
+}
+
+// forget the samples
+void Draw_profiler::clear()
+{
+    widgets.clear();
+    classes.clear();
+}
+
+// calls f(scope, name, entry) for the classes, then the widgets
+void Draw_profiler::for_each_row(const function<void(const char*, const string&, const Entry&)>& f) const
+{
+    // rows sorted by name, so that files can be compared
+    vector< pair<string,const Entry*> > v;
+    for (auto& c : classes) v.push_back({c.second.name,&c.second});
+    sort(v.begin(),v.end());
+    for (auto& r : v) f("class",r.first,*r.second);
+    v.clear();
+    for (auto& w : widgets)
+    {
+        ostringstream name;
+        auto c = classes.find(w.second.type);
+        name << ((c != classes.end()) ? c->second.name : string{}) << " ("
+             << w.second.x << ',' << w.second.y << ' '
+             << w.second.width << 'x' << w.second.height << ')';
+        v.push_back({name.str(),&w.second});
+    }
+    sort(v.begin(),v.end());
+    for (auto& r : v) f("widget",r.first,*r.second);
+}
+
+void Draw_profiler::write_csv(ostream& os) const
+{
+    os << "scope,name,kind,count,total_us,mean_us,p50_us,p99_us,max_us\n";
+    os << fixed << setprecision(3);
+    for_each_row([&os](const char* scope, const string& name, const Entry& e) {
+        for (int k=0; k < 2; k++)
+        {
+            const Latency_histogram& h = e.h[k];
+            if (h.get_count() == 0) continue;
+            os << scope << ",\"" << name << "\"," << kind_names[k] << ',' << h.get_count() << ','
+               << h.get_total()*1e-3 << ',' << h.get_total()*1e-3/h.get_count() << ','
+               << h.percentile(0.5)*1e-3 << ',' << h.percentile(0.99)*1e-3 << ','
+               << h.get_max()*1e-3 << '\n';
+        }
+    });
+}
+
+void Draw_profiler::write_json(ostream& os) const
+{
+    os << "[\n";
+    os << fixed << setprecision(3);
+    bool first = true;
+    for_each_row([&os,&first](const char* scope, const string& name, const Entry& e) {
+        for (int k=0; k < 2; k++)
+        {
+            const Latency_histogram& h = e.h[k];
+            if (h.get_count() == 0) continue;
+            os << (first ? "  " : ",\n  ");
+            first = false;
+            os << "{\"scope\": \"" << scope << "\", \"name\": \"" << name << "\", \"kind\": \""
+               << kind_names[k] << "\", \"count\": " << h.get_count()
+               << ", \"total_us\": " << h.get_total()*1e-3
+               << ", \"mean_us\": " << h.get_total()*1e-3/h.get_count()
+               << ", \"p50_us\": " << h.percentile(0.5)*1e-3
+               << ", \"p99_us\": " << h.percentile(0.99)*1e-3
+               << ", \"max_us\": " << h.get_max()*1e-3 << "}";
+        }
+    });
+    os << "\n]\n";
+}
+
+// the format of the file is chosen by the extension (.json or .csv)
+void Draw_profiler::write(const string& fn) const
+{
+    ofstream os{fn};
+    if (!os)
+        throw runtime_error("Draw_profiler::write(): File " + fn + " cannot be opened!");
+    if ( (fn.size() >= 5) && (fn.compare(fn.size()-5,5,".json") == 0) ) write_json(os);
+    else write_csv(os);
+    if (!os)
+        throw runtime_error("Draw_profiler::write(): File " + fn + " write error!");
+}
+
+} // namespace mathsophy::graphics
@@ -0,0 +1,171 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Draw_profiler.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Draw_profiler_hpp
+#define Draw_profiler_hpp
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+// the profiler is compiled in unless DRAW_PROFILER is 0,
+// then the instrumented methods have no extra code at all
+#ifndef DRAW_PROFILER
+#define DRAW_PROFILER 1
+#endif
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+class Widget;
+
+//
+// profiler enumerations
+//
+
+enum class Draw_kind
+{
+    draw,      // Shape::draw(), the shape alone
+    redraw     // Widget::redraw(), the loop run which follows
+};
+
+//
+// Latency histogram
+//
+
+// durations in nanoseconds in buckets of 1/8 of a power
+// of 2, so a percentile is within 12.5% of the exact value
+class Latency_histogram
+{
+public:
+    void add(uint64_t ns);
+    // the duration below which a fraction q (0 to 1) of the samples are
+    uint64_t percentile(double q) const;
+    // getter methods
+    uint64_t get_count() const { return count; }
+    uint64_t get_total() const { return total; }
+    uint64_t get_max() const { return max_ns; }
+private:
+    static const int nb_buckets{16 + 37*8};   // up to 2^40 ns
+    vector<uint32_t> buckets = vector<uint32_t>(nb_buckets,0);
+    uint64_t count{0};
+    uint64_t total{0};
+    uint64_t max_ns{0};
+};
+
+//
+// Draw profiler
+//
+
+// times of Shape::draw() and Widget::redraw() per widget and per
+// class; off by default, when off a draw costs one test of a flag;
+// used by the UI thread only
+class Draw_profiler
+{
+public:
+    // the profiler of the process
+    static Draw_profiler& instance();
+    // no copy constructor allowed
+    Draw_profiler(const Draw_profiler&) = delete;
+    // no copy assignment allowed
+    Draw_profiler& operator=(const Draw_profiler&) = delete;
+    // setter and getter methods for the runtime switch
+    static void enable(bool on) { enabled = on; }
+    static bool is_enabled() { return enabled; }
+    // add a duration of widget w
+    void record(const Widget* w, Draw_kind k, chrono::steady_clock::duration d);
+    // forget the samples
+    void clear();
+    // one line or object per class and per widget: scope, name, kind,
+    // count, total, mean, p50, p99 and max in microseconds; the
+    // format of the file is chosen by the extension (.json or .csv)
+    void write_csv(ostream& os) const;
+    void write_json(ostream& os) const;
+    void write(const string& fn) const;
+private:
+    Draw_profiler() {}
+    // a sample costs two lookups, the names are only
+    // made when the class or the widget is first seen
+    // and formatted when the rows are written
+    struct Entry
+    {
+        type_index type{typeid(void)}; // class
+        string name;                   // name of a class
+        int x{0}, y{0};                // position and size of a widget
+        int width{0}, height{0};       // when first drawn
+        Latency_histogram h[2];        // draw, redraw
+    };
+    inline static bool enabled{false};
+    unordered_map<const Widget*, Entry> widgets;
+    unordered_map<type_index, Entry> classes;
+    // calls f(scope, name, entry) for the classes, then the widgets
+    void for_each_row(const function<void(const char*, const string&, const Entry&)>& f) const;
+};
+
+//
+// Draw timer
+//
+
+// times its scope for the profiler if enabled
+class Draw_timer
+{
+public:
+    Draw_timer(const Widget* w, Draw_kind k) : wdg{Draw_profiler::is_enabled() ? w : nullptr}, kind{k} {
+        if (wdg) t0 = chrono::steady_clock::now();
+    }
+    Draw_timer(const Draw_timer&) = delete;
+    Draw_timer& operator=(const Draw_timer&) = delete;
+    ~Draw_timer() {
+        if (wdg) Draw_profiler::instance().record(wdg,kind,chrono::steady_clock::now()-t0);
+    }
+private:
+    const Widget* wdg;
+    Draw_kind kind;
+    chrono::steady_clock::time_point t0{};
+};
+
+}
+
+#if DRAW_PROFILER
+#define PROFILE_DRAW(kind) mathsophy::graphics::Draw_timer draw_timer_{this,kind}
+#else
+#define PROFILE_DRAW(kind)
+#endif
+
+#endif /* Draw_profiler_hpp */
@@ -30,6 +30,18 @@
 */
 
 #include "Graphics.hpp"
+#include "Counters.hpp"
+#include "Draw_profiler.hpp"
+#include "Image_cache.hpp"
+#include "Image_scaler.hpp"
+#include "Raster.hpp"
+#include "Scanline_fill.hpp"
+#include "Triangulation.hpp"
+
+#include <FL/Fl_Device.H>
+#include <FL/x.H>
+
+#include <set>
 
 namespace mathsophy::graphics
 {
@@ -136,6 +148,14 @@ Generic_window::Generic_window(Point tl, int w, int h, const char *l = nullptr)
     this->callback(static_exit_callback,this);
 }
 
+// destructor
+Generic_window::~Generic_window()
+{
+    clear();
+    // a later window at the same address is counted anew
+    if (Counters::is_enabled()) Counters::instance().remove(this);
+}
+
 // attach widget to the window
 void Generic_window::attach(Widget& w)
 {
@@ -143,6 +163,16 @@ void Generic_window::attach(Widget& w)
     w.attach(this);  // attach the window to the widget
 }
 
+// override draw, counts the frames
+void Generic_window::draw()
+{
+    if (!Counters::is_enabled())
+        return Fl_Window::draw();
+    Counters::instance().begin_frame(this);
+    Fl_Window::draw();
+    Counters::instance().end_frame(this);
+}
+
 // override show
 void Generic_window::show()
 {
@@ -196,6 +226,17 @@ void Simple_window::wait_for_button()
     while( !is_button_pressed() ) Fl::wait();
 }
 
+// waits until the text of in changes (true) or
+// the Next button is pressed (false)
+bool Simple_window::wait_for_input_change(In_box& in)
+{
+    size_t n = in.get_changes();
+    while ( (in.get_changes() == n) && !button_pressed ) Fl::wait();
+    if (in.get_changes() != n) return true;
+    button_pressed = false;
+    return false;
+}
+
 bool Simple_window::is_button_pressed()
 {
     if (button_pressed)
@@ -210,9 +251,25 @@ bool Simple_window::is_button_pressed()
 // Widget
 //
 
+// destructor
+Widget::~Widget()
+{
+    // work counted before the widget was attached goes to no window
+    if (Counters::is_enabled()) Counters::instance().remove(this);
+}
+
+// attach internal FLTK widgets to the window
+void Widget::attach(Generic_window* w)
+{
+    win = w;
+    // work counted before the attachment goes to the window
+    if (Counters::is_enabled()) Counters::instance().attach(this,w);
+}
+
 // overrides Fl_Widget::redraw()
 void Widget::redraw()
 {
+    PROFILE_DRAW(Draw_kind::redraw);
     Fl_Widget::redraw();
     Fl::wait(0);
 }
@@ -249,16 +306,62 @@ void Widget:: update_tl_br(const Point& p)
 // overrides Widget::draw()
 void Shape::draw()
 {
+    PROFILE_DRAW(Draw_kind::draw);
     set_fl_style();
     if ( is_visible() ) draw_shape();
     restore_fl_style();
 }
 
+// draws the shape into a software raster
+// instead of the current FLTK window
+void Shape::render(Raster& r) const
+{
+    if ( !is_visible() ) return;
+    // clipping to the render box makes the result independent
+    // of how the raster is split into tiles
+    pair<Point,Point> box = get_render_box();
+    r.push_clip(box.first.x,box.first.y,
+                box.second.x-box.first.x,box.second.y-box.first.y);
+    // translucent shapes are drawn into a layer which
+    // is then composited over the raster as a whole
+    if ( !is_opaque() ) r.begin_layer();
+    Fl_Color c = r.color();
+    r.color(new_color);
+    r.line_style(line_style,line_width);
+    r.font(new_font,new_fontsize);
+    render_shape(r);
+    r.color(c);
+    r.line_style(0);
+    if ( !is_opaque() ) r.end_layer(uchar(get_alpha()));
+    r.pop_clip();
+}
+
+// area [tl,br) the software rendering is clipped to
+pair<Point,Point> Shape::get_render_box() const
+{
+    // corners are not ordered for lines going up or left
+    Point a = get_tl();
+    Point b = get_br();
+    int m = max(line_width,1)+1;
+    return { Point{min(a.x,b.x)-m,min(a.y,b.y)-m},
+             Point{max(a.x,b.x)+m+1,max(a.y,b.y)+m+1} };
+}
+
+// grows the render box b to contain the area [tl,br)
+static void grow_box(pair<Point,Point>& b, Point tl, Point br)
+{
+    b.first.x  = min(b.first.x,tl.x);
+    b.first.y  = min(b.first.y,tl.y);
+    b.second.x = max(b.second.x,br.x);
+    b.second.y = max(b.second.y,br.y);
+}
+
 // moves a shape relative to the current
 // top-left corner (call of redraw()
 // might be needed)
 void Shape::move(int dx, int dy)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     move_shape(dx,dy);
     show();
@@ -269,6 +372,7 @@ void Shape::move(int dx, int dy)
 // (call of redraw() might be needed)
 void Shape::set_color(Color_type c)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     set_color_shape(c);
     show();
@@ -276,6 +380,7 @@ void Shape::set_color(Color_type c)
 
 void Shape::set_color(int c)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     set_color_shape(c);
     show();
@@ -283,6 +388,7 @@ void Shape::set_color(int c)
 
 void Shape::set_style(Style_type s, int w)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     set_style_shape(s,w);
     show();
@@ -290,6 +396,7 @@ void Shape::set_style(Style_type s, int w)
 
 void Shape::set_font(Font_type f, int s)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     set_font_shape(f,s);
     show();
@@ -312,7 +419,7 @@ void Shape::set_fl_style()
 {
     fl_line_style(line_style,line_width);
     old_color = fl_color();
-    fl_color(new_color);
+    fl_color(to_fl_shape_color(new_color));
 }
 
 void Shape::restore_fl_style()
@@ -321,6 +428,16 @@ void Shape::restore_fl_style()
     fl_line_style(0);
 }
 
+// FLTK cannot blend, translucent shapes are drawn
+// with c mixed with the window background
+Fl_Color Shape::to_fl_shape_color(Fl_Color c) const
+{
+    if ( is_opaque() )
+        return c;
+    Fl_Color bg = window() ? window()->color() : FL_BACKGROUND_COLOR;
+    return fl_color_average(c,bg,get_alpha()/255.0f);
+}
+
 void Shape::set_fl_font()
 {
     old_font = fl_font();
@@ -339,10 +456,181 @@ void Shape::draw_outline()
     fl_rect(get_tl().x,get_tl().y,w(),h());
 }
 
+//
+// Batched drawing
+//
+
+// connected points drawn as one path, closed back to the first
+// point if loop is true; very long paths are split so that no
+// request exceeds what the window system accepts; returns the
+// number of calls to the graphics backend
+static size_t draw_polyline(const Point* p, size_t n, bool loop)
+{
+    const size_t batch = 16384;
+    if (n < 2)
+        return 0;
+    if ( (n == 2) && !loop )
+    {
+        fl_line(p[0].x,p[0].y,p[1].x,p[1].y);
+        return 1;
+    }
+    if ( loop && (n <= batch) )
+    {
+        fl_begin_loop();
+        for (size_t i=0; i < n; i++)
+            fl_vertex(p[i].x,p[i].y);
+        fl_end_loop();
+        return 1;
+    }
+    size_t calls = 0;
+    for (size_t i=0; i+1 < n; i += batch-1)
+    {
+        fl_begin_line();
+        for (size_t j=i; j < min(n,i+batch); j++)
+            fl_vertex(p[j].x,p[j].y);
+        fl_end_line();
+        calls++;
+    }
+    if (loop)
+    {
+        fl_line(p[n-1].x,p[n-1].y,p[0].x,p[0].y);
+        calls++;
+    }
+    return calls;
+}
+
+// disjoint segments: on the display they are sent to the window
+// system in batches (one stroked path with Quartz, XDrawSegments
+// with X11), other surfaces such as printers get one fl_line each;
+// returns the number of calls to the graphics backend
+static size_t draw_segments(const pair<Point,Point>* l, size_t n, int width)
+{
+    if (n == 0)
+        return 0;
+#if defined(__APPLE__)
+    if (Fl_Surface_Device::surface() == Fl_Display_Device::display_device())
+    {
+        // as fl_line(), thick lines are anti-aliased
+        if (width > 1) CGContextSetShouldAntialias(fl_gc,true);
+        for (size_t i=0; i < n; i++)
+        {
+            CGContextMoveToPoint(fl_gc,l[i].first.x,l[i].first.y);
+            CGContextAddLineToPoint(fl_gc,l[i].second.x,l[i].second.y);
+        }
+        CGContextStrokePath(fl_gc);
+        if (width > 1) CGContextSetShouldAntialias(fl_gc,false);
+        return 1;
+    }
+#elif !defined(_WIN32)
+    if (Fl_Surface_Device::surface() == Fl_Display_Device::display_device())
+    {
+        // X11 coordinates are 16 bits, clamped as fl_line() does
+        const int lim = 32767 - max(width,1);
+        auto clamp16 = [lim](int v) { return short(min(max(v,-lim),lim)); };
+        const size_t batch = 4096;
+        XSegment s[batch];
+        size_t calls = 0;
+        for (size_t i=0; i < n; i += batch)
+        {
+            size_t k = min(batch,n-i);
+            for (size_t j=0; j < k; j++)
+                s[j] = XSegment{clamp16(l[i+j].first.x),clamp16(l[i+j].first.y),
+                                clamp16(l[i+j].second.x),clamp16(l[i+j].second.y)};
+            XDrawSegments(fl_display,fl_window,fl_gc,s,int(k));
+            calls++;
+        }
+        return calls;
+    }
+#endif
+    for (size_t i=0; i < n; i++)
+        fl_line(l[i].first.x,l[i].first.y,l[i].second.x,l[i].second.y);
+    return n;
+}
+
+// filled rectangles collected and sent to the window system in
+// batches on the display (CGContextFillRects with Quartz,
+// XFillRectangles with X11), other surfaces such as printers
+// get one fl_rectf each
+class Rect_batch
+{
+public:
+    // constructor
+    Rect_batch() : display{Fl_Surface_Device::surface() == Fl_Display_Device::display_device()} {}
+    // add a rectangle, sending the batch when full
+    void add(int x, int y, int w, int h)
+    {
+#if defined(__APPLE__)
+        if (display)
+        {
+            // same pixels as fl_rectf()
+            r[n++] = CGRectMake(x-0.5,y-0.5,w,h);
+            if (n == batch) flush();
+            return;
+        }
+#elif !defined(_WIN32)
+        if (display)
+        {
+            // the caller clips to the visible area, which fits
+            // into the 16 bits of X11 coordinates
+            r[n++] = XRectangle{short(x),short(y),(unsigned short)w,(unsigned short)h};
+            if (n == batch) flush();
+            return;
+        }
+#endif
+        fl_rectf(x,y,w,h);
+        calls++;
+    }
+    // send the rest, returns the number of calls
+    // to the graphics backend
+    size_t finish()
+    {
+        flush();
+        return calls;
+    }
+private:
+    static const size_t batch = 4096;
+    bool display;               // drawing to the display
+    size_t n{0};                // rectangles waiting
+    size_t calls{0};            // calls to the graphics backend
+#if defined(__APPLE__)
+    CGRect r[batch];
+#elif !defined(_WIN32)
+    XRectangle r[batch];
+#endif
+    void flush()
+    {
+        if (n == 0)
+            return;
+#if defined(__APPLE__)
+        CGContextFillRects(fl_gc,r,n);
+#elif !defined(_WIN32)
+        XFillRectangles(fl_display,fl_window,fl_gc,r,int(n));
+#endif
+        n = 0;
+        calls++;
+    }
+};
+
 //
 // Line
 //
 
+// getter and setter methods
+void Line::set_line(pair<Point,Point> line)
+{
+    l = line;
+    // after any update of the line,
+    // resize must be called
+    resize_widget(l.first,l.second);
+}
+
+// override Shape::draw_shape
+void Line::draw_shape()
+{
+    fl_line(l.first.x, l.first.y, l.second.x, l.second.y);
+    count_work(Counter_type::draw_calls,this);
+}
+
 // override Shape::move_shape
 void Line::move_shape(int dx, int dy)
 {
@@ -353,6 +641,12 @@ void Line::move_shape(int dx, int dy)
     resize_widget(l.first,l.second);
 }
 
+// override Shape::render_shape
+void Line::render_shape(Raster& r) const
+{
+    r.line(l.first.x, l.first.y, l.second.x, l.second.y);
+}
+
 //
 // Lines
 //
@@ -360,9 +654,9 @@ void Line::move_shape(int dx, int dy)
 // add a line to the vector of lines
 void Lines::add_line(pair<Point,Point> line)
 {
-    pair<Point,Point>* l = new pair<Point,Point>;
-    l->first = line.first; l->second = line.second;
-    vl.push_back(l);
+    if (vl.size() == vl.capacity())
+        count_work(Counter_type::point_allocs,this);
+    vl.push_back(line);
     // after any update of the vector of lines
     // resize must be called
     resize_widget();
@@ -371,7 +665,6 @@ void Lines::add_line(pair<Point,Point> line)
 // remove the i-th line
 void Lines::remove_line(size_t i)
 {
-    delete vl.at(i);
     vl.erase(vl.begin()+i);
     // after any update of the vector of lines
     // resize must be called
@@ -381,15 +674,18 @@ void Lines::remove_line(size_t i)
 // getter and setter methods
 void Lines::set_line(size_t i, pair<Point,Point> line)
 {
-    pair<Point,Point>* l = new pair<Point,Point>;
-    l->first = line.first; l->second = line.second;
-    delete vl.at(i);
-    vl.at(i) = l;
+    vl.at(i) = line;
     // after any update of the vector of lines
     // resize must be called
     resize_widget();
 }
 
+// all the lines in one batch
+void Lines::draw_shape()
+{
+    count_work(Counter_type::draw_calls,this,draw_segments(vl.data(),vl.size(),get_width()));
+}
+
 // override Widget::resize_widget
 void Lines::resize_widget()
 {
@@ -398,11 +694,13 @@ void Lines::resize_widget()
         return;
     // depending on the sizes of the individual lines stored, the
     // overall size of the widget must be updated
-    set_tl(vl[0]->first);
-    set_br(vl[0]->second);
-    for (auto l : vl) {
-        update_tl_br(l->first);
-        update_tl_br(l->second);
+    count_work(Counter_type::resize_scans,this);
+    count_work(Counter_type::resize_points,this,2*vl.size());
+    set_tl(vl[0].first);
+    set_br(vl[0].second);
+    for (auto& l : vl) {
+        update_tl_br(l.first);
+        update_tl_br(l.second);
     }
     Widget::resize_widget();
 }
@@ -410,15 +708,22 @@ void Lines::resize_widget()
 // override Shape::move_shape
 void Lines::move_shape(int dx, int dy)
 {
-    for (auto l : vl) {
-        l->first.x += dx; l->first.y += dy;
-        l->second.x += dx; l->second.y += dy;
+    for (auto& l : vl) {
+        l.first.x += dx; l.first.y += dy;
+        l.second.x += dx; l.second.y += dy;
     }
     // after any update of the vector of lines
     // resize must be called
     resize_widget();
 }
 
+// override Shape::render_shape
+void Lines::render_shape(Raster& r) const
+{
+    for (auto& l : vl)
+        r.line(l.first.x, l.first.y, l.second.x, l.second.y);
+}
+
 //
 // Open_polyline
 //
@@ -426,7 +731,10 @@ void Lines::move_shape(int dx, int dy)
 // add a new point
 void Open_polyline::add_point(Point p)
 {
-    vp.push_back(new Point{p});
+    if (vp.size() == vp.capacity())
+        count_work(Counter_type::point_allocs,this);
+    vp.push_back(p);
+    points_changed();
     // after any update of the vector of points
     // resize must be called
     resize_widget();
@@ -435,8 +743,8 @@ void Open_polyline::add_point(Point p)
 // remove the i-th point
 void Open_polyline::remove_point(size_t i)
 {
-    delete vp.at(i);
     vp.erase(vp.begin()+i);
+    points_changed();
     // after any update of the vector of points
     // resize must be called
     resize_widget();
@@ -445,10 +753,8 @@ void Open_polyline::remove_point(size_t i)
 // getter and setter methods
 void Open_polyline::set_point(size_t i, Point pnt)
 {
-    Point* p = new Point;
-    *p = pnt;
-    delete vp.at(i);
-    vp.at(i) = p;
+    vp.at(i) = pnt;
+    points_changed();
     // after any update of the vector of points
     // resize must be called
     resize_widget();
@@ -457,8 +763,7 @@ void Open_polyline::set_point(size_t i, Point pnt)
 void Open_polyline::draw_shape()
 {
     // connect each consecutive points
-    for (size_t n=0; n < vp.size()-1; n++)
-        fl_line(vp[n]->x, vp[n]->y, vp[n+1]->x, vp[n+1]->y);
+    count_work(Counter_type::draw_calls,this,draw_polyline(vp.data(),vp.size(),false));
 }
 
 void Open_polyline::resize_widget()
@@ -468,127 +773,345 @@ void Open_polyline::resize_widget()
         return;
     // depending on where the points are, the
     // overall size of the widget must be updated
-    set_tl(*vp[0]);
-    set_br(*vp[0]);
-    for (auto p : vp)
-        update_tl_br(*p);
+    count_work(Counter_type::resize_scans,this);
+    count_work(Counter_type::resize_points,this,vp.size());
+    set_tl(vp[0]);
+    set_br(vp[0]);
+    for (auto& p : vp)
+        update_tl_br(p);
     Widget::resize_widget();
 }
 
 void Open_polyline::move_shape(int dx,int dy)
 {
-    for (auto p : vp) {
-        p->x += dx;
-        p->y += dy;
+    for (auto& p : vp) {
+        p.x += dx;
+        p.y += dy;
     }
+    points_changed();
     // after any update of the vector of points
     // resize must be called
     resize_widget();
 }
 
+void Open_polyline::render_shape(Raster& r) const
+{
+    // connect each consecutive points
+    for (size_t n=1; n < vp.size(); n++)
+        r.line(vp[n-1].x, vp[n-1].y, vp[n].x, vp[n].y);
+}
+
 //
 // Closed_polyline
 //
 
+// virtual destructor
+Closed_polyline::~Closed_polyline()
+{
+    delete tri;
+}
+
 // redefine Open_polyline::draw_shape
 void Closed_polyline::draw_shape()
 {
-    Open_polyline::draw_shape();
+    // connect each consecutive points and
+    // the last one back to the first
+    const vector<Point>& p = get_points();
+    count_work(Counter_type::draw_calls,this,draw_polyline(p.data(),p.size(),true));
+}
+
+void Closed_polyline::render_shape(Raster& r) const
+{
+    if (empty_points())
+        return;
+    Open_polyline::render_shape(r);
     // last line in order to close the shape
-    fl_line(get_point(get_nb_points()-1).x, get_point(get_nb_points()-1).y, get_point(0).x, get_point(0).y);
+    Point first = get_point(0);
+    Point last = get_point(get_nb_points()-1);
+    r.line(last.x, last.y, first.x, first.y);
+}
+
+// queries answered by the triangulation
+const vector<uint32_t>& Closed_polyline::get_triangles() const
+{
+    return get_triangulation().get_indices();
+}
+
+double Closed_polyline::get_area() const
+{
+    return get_triangulation().get_area();
+}
+
+Point Closed_polyline::get_centroid() const
+{
+    return get_triangulation().get_centroid();
+}
+
+bool Closed_polyline::contains(Point p) const
+{
+    return get_triangulation().contains(p);
+}
+
+// forget the triangles of the old points
+void Closed_polyline::points_changed()
+{
+    lock_guard<mutex> lock{cache_mutex};
+    delete tri;
+    tri = nullptr;
+}
+
+// triangulation computed once per change of the points
+const Triangulation& Closed_polyline::get_triangulation() const
+{
+    lock_guard<mutex> lock{cache_mutex};
+    if (!tri)
+        tri = new Triangulation{get_points().data(),get_nb_points()};
+    return *tri;
 }
 
 //
 // Polygon
 //
 
+// twice the signed area of the triangle a, b, c: positive if c
+// is on the left of the line from a to b, zero if on the line
+static long long cross(Point a, Point b, Point c)
+{
+    return (long long)(b.x-a.x)*(c.y-a.y) - (long long)(b.y-a.y)*(c.x-a.x);
+}
+
+// virtual destructor
+Polygon::~Polygon()
+{
+    delete fill;
+}
+
 // redefine Closed_polyline::draw_shape
 void Polygon::draw_shape()
 {
-    if (!intersect())
+    if (!is_simple())
+        throw runtime_error("Polygon::draw_shape(): Intersections found!");
+    if (filled && (get_nb_points() > 2))
+    {
+        // the whole vertex array is handed over at once,
+        // the backend fills it in a single call
+        fl_begin_complex_polygon();
+        for (auto& p : get_points())
+            fl_vertex(p.x,p.y);
+        fl_end_complex_polygon();
+        count_work(Counter_type::draw_calls,this);
+    }
+    if (outline)
+    {
+        // outline in black around the inside
+        if (filled)
+            fl_color(to_fl_shape_color(FL_BLACK));
         Closed_polyline::draw_shape();
-    else throw runtime_error("Polygon::draw_shape(): Intersections found!");
+    }
 }
 
-// detects if there is an intersection
-bool Polygon::intersect()
+void Polygon::render_shape(Raster& r) const
 {
-    // build vector of lines
-    vector< pair<Point,Point>* > vl;
-    for (size_t i=0; i < get_nb_points(); i++)
+    if (!is_simple())
+        throw runtime_error("Polygon::render_shape(): Intersections found!");
+    if (filled)
+        get_fill().render(r);
+    if (outline)
     {
-        // a line is represented as a pair of points
-        pair<Point,Point>* l = new pair<Point,Point>;
-        l->first  = get_point(i);
-        l->second = get_point( (i+1) % get_nb_points() );
-        vl.push_back(l);
+        // outline in black around the inside
+        if (filled)
+            r.color(FL_BLACK);
+        Closed_polyline::render_shape(r);
     }
+}
+
+// forget the results computed for the old points
+void Polygon::points_changed()
+{
+    Closed_polyline::points_changed();
+    lock_guard<mutex> lock{cache_mutex};
+    checked = false;
+    delete fill;
+    fill = nullptr;
+}
+
+// intersect() computed once per change of the points
+bool Polygon::is_simple() const
+{
+    lock_guard<mutex> lock{cache_mutex};
+    if (!checked)
+    {
+        simple = !intersect();
+        checked = true;
+    }
+    return simple;
+}
+
+// scanline fill computed once per change of the points
+const Scanline_fill& Polygon::get_fill() const
+{
+    lock_guard<mutex> lock{cache_mutex};
+    if (!fill)
+        fill = new Scanline_fill{get_points().data(),get_nb_points()};
+    return *fill;
+}
+
+// detects if there is an intersection with a sweep line moving
+// from left to right (Shamos-Hoey): the sides it crosses are kept
+// sorted from bottom to top, and the first intersection is always
+// between two sides which have been neighbours in this order, so
+// a side is only tested against its neighbours when it is inserted,
+// and these against each other when it is removed: O(n log n)
+// whatever the length of the sides
+bool Polygon::intersect() const
+{
+    // a triangle has only adjacent sides
+    const vector<Point>& p = get_points();
+    size_t n = p.size();
+    if (n < 4)
+        return false;
     
-    // double loop over the lines
-    for (size_t i=0; i < vl.size(); i++)
+    // a repeated point makes the sides before
+    // and after it touch each other
+    for (size_t i=0; i < n; i++)
+        if ( (p[i].x == p[(i+1) % n].x) && (p[i].y == p[(i+1) % n].y) )
+            return true;
+    
+    // points ordered by x, then by y
+    auto before = [](Point a, Point b) {
+        return (a.x < b.x) || ((a.x == b.x) && (a.y < b.y));
+    };
+    
+    // the i-th side goes from p[i] to p[i+1],
+    // it is stored with its left end point first
+    vector< pair<Point,Point> > sides(n);
+    for (size_t i=0; i < n; i++)
     {
-        // indeces of the adjacent lines
-        size_t prev = (i-1) % vl.size();
-        size_t next = (i+1) % vl.size();
-        for (size_t j=i+1; j < vl.size(); j++)
+        Point a = p[i], b = p[(i+1) % n];
+        sides[i] = before(b,a) ? make_pair(b,a) : make_pair(a,b);
+    }
+    
+    // the sweep line stops at every point, in the order of
+    // their coordinates packed into one unsigned key each
+    auto key = [](Point q) {
+        return (uint64_t(uint32_t(q.x) ^ 0x80000000u) << 32) | (uint32_t(q.y) ^ 0x80000000u);
+    };
+    vector< pair<uint64_t,size_t> > stops(n);
+    for (size_t k=0; k < n; k++)
+        stops[k] = { key(p[k]), k };
+    sort(stops.begin(),stops.end());
+    
+    // side i below side j where they are both crossed by the sweep
+    // line: the side starting later is compared to the line of the
+    // other one by its left end point, or by its right end point
+    // if the left one is on that line; the order cannot change
+    // while they are crossed, as long as they do not intersect
+    auto below = [&](size_t i, size_t j) {
+        if (i == j)
+            return false;
+        const pair<Point,Point>& si = sides[i];
+        const pair<Point,Point>& sj = sides[j];
+        bool i_later = before(sj.first,si.first) ||
+                       ( !before(si.first,sj.first) && (i > j) );
+        const pair<Point,Point>& a = i_later ? sj : si;
+        const pair<Point,Point>& b = i_later ? si : sj;
+        long long o = cross(a.first,a.second,b.first);
+        if (o == 0)
+            o = cross(a.first,a.second,b.second);
+        if (o == 0)
+            return i < j;
+        return i_later ? (o < 0) : (o > 0);
+    };
+    
+    // sides i and j cross or touch; adjacent sides always share
+    // a point, they only intersect if the second one goes back
+    // along the first one, which could hide other sides from
+    // each other in the sweep order
+    auto crossing = [&](size_t i, size_t j) {
+        if ( (j == (i+1) % n) || (i == (j+1) % n) )
         {
-            // skip the adjacent lines
-            if ( (j != prev) && (j != next) )
+            size_t k = (j == (i+1) % n) ? i : j;
+            Point a = p[k], v = p[(k+1) % n], b = p[(k+2) % n];
+            return (cross(v,a,b) == 0) &&
+                   ((long long)(a.x-v.x)*(b.x-v.x) + (long long)(a.y-v.y)*(b.y-v.y) > 0);
+        }
+        Point Pa = sides[i].first;
+        Point Pb = sides[i].second;
+        Point Pc = sides[j].first;
+        Point Pd = sides[j].second;
+        return lines_intersect(Pa,Pb,Pc,Pd);
+    };
+    
+    // sides crossed by the sweep line, from bottom to top
+    set<size_t,decltype(below)> sweep{below};
+    vector<set<size_t,decltype(below)>::iterator> at(n);
+    for (size_t g=0; g < n; )
+    {
+        // points at the same place are one stop
+        size_t h = g+1;
+        while ( (h < n) && (stops[h].first == stops[g].first) )
+            h++;
+        // the sides starting at the stop are inserted before
+        // the sides ending there are removed, so that sides
+        // touching each other there are neighbours once
+        for (bool start : {true,false})
+            for (size_t s=g; s < h; s++)
             {
-                Point Pa = vl[i]->first;
-                Point Pb = vl[i]->second;
-                Point Pc = vl[j]->first;
-                Point Pd = vl[j]->second;
-                if (lines_intersect(Pa,Pb,Pc,Pd))
+                size_t k = stops[s].second;
+                // the sides before and after the k-th point
+                for (size_t i : {(k+n-1) % n,k})
                 {
-                    // free storage
-                    for (auto l : vl) delete l;
-                    return true;
+                    Point q = sides[i].first;
+                    if ( ((q.x == p[k].x) && (q.y == p[k].y)) != start )
+                        continue;
+                    if (start)
+                    {
+                        auto j = sweep.insert(i).first;
+                        at[i] = j;
+                        if ( (j != sweep.begin()) && crossing(*prev(j),i) )
+                            return true;
+                        if ( (next(j) != sweep.end()) && crossing(*next(j),i) )
+                            return true;
+                    }
+                    else
+                    {
+                        auto j = at[i];
+                        if ( (j != sweep.begin()) && (next(j) != sweep.end()) &&
+                             crossing(*prev(j),*next(j)) )
+                            return true;
+                        sweep.erase(j);
+                    }
                 }
             }
-        }
+        g = h;
     }
     
-    // free storage
-    for (auto l : vl) delete l;
     return false;
 }
 
-// given 2 lines tests for intersection
+// given 2 lines tests for intersection, lines touching
+// each other intersect too: they intersect if the end points
+// of each line are not strictly on the same side of the other
+// line, or if an end point lies on the other line
 bool Polygon::lines_intersect(Point& Pa, Point& Pb, Point& Pc, Point& Pd)
 {
-    // naive algorithm: standard solution of intersecting lines
-    int m1 = Pb.y - Pa.y;
-    int m2 = Pb.x - Pa.x;
-    int m3 = Pd.y - Pc.y;
-    int m4 = Pd.x - Pc.x;
-    int m5 = Pc.y - Pa.y;
-    int m6 = Pc.x - Pa.x;
-    
-    long m = m1*m4 - m2*m3;
-    long n = m1*m4*Pa.x + m2*(m4*m5 - m3*Pc.x);
-    long o = m1*(m4*m5 - m3*m6) + m*Pa.y;
-    
-    // no division required but we need to check the sign of m
-    // xp = double(n)/m
-    // yp = double(o)/m
-    if (m > 0)
-    {
-        if ( ((m*Pc.x <= n) && (n <= m*Pd.x)) &&
-             ((m*Pa.x <= n) && (n <= m*Pb.x)) &&
-             ((m*Pb.y <= o) && (o <= m*Pa.y)) &&
-             ((m*Pc.y <= o) && (o <= m*Pd.y))
-           ) return true;
-        else return false;
-    } else
-    {
-        if ( ((m*Pc.x >= n) && (n >= m*Pd.x)) &&
-             ((m*Pa.x >= n) && (n >= m*Pb.x)) &&
-             ((m*Pb.y >= o) && (o >= m*Pa.y)) &&
-             ((m*Pc.y >= o) && (o >= m*Pd.y))
-           ) return true;
-        else return false;
-    }    
+    auto side = [](Point a, Point b, Point c) {
+        long long o = cross(a,b,c);
+        return (o > 0) - (o < 0);
+    };
+    int d1 = side(Pc,Pd,Pa);
+    int d2 = side(Pc,Pd,Pb);
+    int d3 = side(Pa,Pb,Pc);
+    int d4 = side(Pa,Pb,Pd);
+    if ( (d1*d2 < 0) && (d3*d4 < 0) )
+        return true;
+    // c lies on the line from a to b, within its end points
+    auto on = [](Point a, Point b, Point c) {
+        return (min(a.x,b.x) <= c.x) && (c.x <= max(a.x,b.x)) &&
+               (min(a.y,b.y) <= c.y) && (c.y <= max(a.y,b.y));
+    };
+    return ( (d1 == 0) && on(Pc,Pd,Pa) ) || ( (d2 == 0) && on(Pc,Pd,Pb) ) ||
+           ( (d3 == 0) && on(Pa,Pb,Pc) ) || ( (d4 == 0) && on(Pa,Pb,Pd) );
 }
 
 //
@@ -605,11 +1128,25 @@ void Rectangle::draw_shape()
     if (outline)
     {
         // outline in black
-        fl_color(FL_BLACK);
+        fl_color(to_fl_shape_color(FL_BLACK));
         fl_rect(tl.x,tl.y,br.x-tl.x,br.y-tl.y);
     }
 }
 
+void Rectangle::render_shape(Raster& r) const
+{
+    Point tl = get_tl();
+    Point br = get_br();
+    if (filled)
+        r.rectf(tl.x,tl.y,br.x-tl.x,br.y-tl.y);
+    if (outline)
+    {
+        // outline in black
+        r.color(FL_BLACK);
+        r.rect(tl.x,tl.y,br.x-tl.x,br.y-tl.y);
+    }
+}
+
 void Rectangle::move_shape(int dx, int dy)
 {
     Point tl = get_tl();
@@ -646,17 +1183,33 @@ void Text::draw_shape()
     restore_fl_font();
 }
 
+void Text::render_shape(Raster& r) const
+{
+    r.draw(t,bl.x,bl.y);
+}
+
 void Text::move_shape(int dx,int dy)
 {
     bl.x += dx; bl.y += dy;
     resize_text();
 }
 
+// the built-in font of the raster is wider
+// than the FLTK text extents of the widget
+pair<Point,Point> Text::get_render_box() const
+{
+    pair<Point,Point> b = Shape::get_render_box();
+    grow_box(b,Point{bl.x,bl.y-Raster::text_height(get_fontsize())},
+               Point{bl.x+Raster::text_width(t,get_fontsize()),bl.y+1});
+    return b;
+}
+
 // resize according to text size
 void Text::resize_text()
 {
     int x{0},y{0},w{0},h{0};
     fl_text_extents(t.c_str(),x,y,w,h);
+    count_work(Counter_type::text_extents,this);
     resize_widget(Point{bl.x+x,bl.y+y},Point{bl.x+x+w,bl.y+y+h});
 }
 
@@ -691,6 +1244,260 @@ void Circle::move_shape(int dx,int dy)
     resize_widget(Point{c.x-r,c.y-r},Point{c.x+r,c.y+r});
 }
 
+void Circle::render_shape(Raster& rst) const
+{
+    Point tl = get_tl();
+    Point br = get_br();
+    rst.arc(tl.x,tl.y,br.x-tl.x,br.y-tl.y);
+}
+
+//
+// Circles
+//
+
+// constructor and destructor are defined here,
+// where the stamps are complete types
+Circles::Circles()
+{
+}
+
+// virtual destructor
+Circles::~Circles()
+{
+}
+
+// add a circle
+void Circles::add_circle(Point c, int r)
+{
+    if (cs.size() == cs.capacity())
+        count_work(Counter_type::point_allocs,this);
+    cs.push_back(c);
+    rs.push_back(r);
+    radii[r]++;
+    changed();
+    // a new circle can only make the widget larger,
+    // the other ones need not be scanned again
+    Point a{c.x-r,c.y-r}, b{c.x+r,c.y+r};
+    if (cs.size() == 1)
+    {
+        set_tl(a);
+        set_br(b);
+    } else
+    {
+        update_tl_br(a);
+        update_tl_br(b);
+    }
+    Widget::resize_widget();
+}
+
+// remove the i-th circle
+void Circles::remove_circle(size_t i)
+{
+    if (--radii[rs.at(i)] == 0)
+        radii.erase(rs[i]);
+    cs.erase(cs.begin()+i);
+    rs.erase(rs.begin()+i);
+    changed();
+    // after any update of the circles
+    // resize must be called
+    resize_widget();
+}
+
+// getter and setter methods
+void Circles::set_circle(size_t i, Point c, int r)
+{
+    if (--radii[rs.at(i)] == 0)
+        radii.erase(rs[i]);
+    radii[r]++;
+    cs[i] = c;
+    rs[i] = r;
+    changed();
+    // after any update of the circles
+    // resize must be called
+    resize_widget();
+}
+
+void Circles::set_filled(bool flag)
+{
+    filled = flag;
+    // the stamps are made again at the next drawing
+    lock_guard<mutex> lock{cache_mutex};
+    stamps.clear();
+}
+
+// override Widget::resize_widget
+void Circles::resize_widget()
+{
+    // nothing to do if no circles
+    if (cs.empty())
+        return;
+    count_work(Counter_type::resize_scans,this);
+    count_work(Counter_type::resize_points,this,cs.size());
+    set_tl(Point{cs[0].x-rs[0],cs[0].y-rs[0]});
+    set_br(Point{cs[0].x+rs[0],cs[0].y+rs[0]});
+    for (size_t i=0; i < cs.size(); i++)
+    {
+        update_tl_br(Point{cs[i].x-rs[i],cs[i].y-rs[i]});
+        update_tl_br(Point{cs[i].x+rs[i],cs[i].y+rs[i]});
+    }
+    Widget::resize_widget();
+}
+
+// override Shape::move_shape
+void Circles::move_shape(int dx, int dy)
+{
+    for (auto& c : cs)
+    {
+        c.x += dx;
+        c.y += dy;
+    }
+    // the grid, its copies of the centers and the
+    // widget move along, no binning or scan needed
+    {
+        lock_guard<mutex> lock{cache_mutex};
+        grid_tl.x += dx;
+        grid_tl.y += dy;
+        for (auto& c : bin_cs)
+        {
+            c.x += dx;
+            c.y += dy;
+        }
+    }
+    Point tl = get_tl();
+    Point br = get_br();
+    Widget::resize_widget(Point{tl.x+dx,tl.y+dy},Point{br.x+dx,br.y+dy});
+}
+
+// the circles must be binned again
+void Circles::changed()
+{
+    lock_guard<mutex> lock{cache_mutex};
+    binned = false;
+}
+
+// stamps for all the radii in use and the current line width,
+// made at most once per radius, and the circles binned by their
+// center into a grid of square cells: the copies are stored cell
+// after cell, so that drawing reads them in order
+void Circles::update_caches() const
+{
+    lock_guard<mutex> lock{cache_mutex};
+    int w = max(get_width(),1);
+    if (w != stamp_width)
+    {
+        stamps.clear();
+        stamp_width = w;
+    }
+    for (auto& r : radii)
+        if (stamps.find(r.first) == stamps.end())
+            stamps[r.first] = Raster::ellipse_spans(2*r.first,2*r.first,w,filled);
+    if (binned || cs.empty())
+        return;
+    
+    // cells of at least 32 pixels, about one circle per cell
+    // for sparse plots
+    Point tl = cs[0], br = cs[0];
+    for (auto& c : cs)
+    {
+        tl.x = min(tl.x,c.x); tl.y = min(tl.y,c.y);
+        br.x = max(br.x,c.x); br.y = max(br.y,c.y);
+    }
+    double gw = double(br.x)-tl.x+1, gh = double(br.y)-tl.y+1;
+    cell = int(max({32.0,sqrt(gw*gh/cs.size()),max(gw,gh)/cs.size()}));
+    cols = int(gw/cell)+1;
+    rows = int(gh/cell)+1;
+    grid_tl = tl;
+    
+    // counting sort of the circles by cell
+    auto cell_of = [this](Point c) {
+        return size_t((c.y-grid_tl.y)/cell)*cols + size_t((c.x-grid_tl.x)/cell);
+    };
+    first.assign(size_t(cols)*rows+1,0);
+    for (auto& c : cs)
+        first[cell_of(c)+1]++;
+    for (size_t c=1; c < first.size(); c++)
+        first[c] += first[c-1];
+    bin_cs.resize(cs.size());
+    bin_rs.resize(rs.size());
+    vector<uint32_t> fill_at(first.begin(),first.end()-1);
+    for (size_t i=0; i < cs.size(); i++)
+    {
+        uint32_t k = fill_at[cell_of(cs[i])]++;
+        bin_cs[k] = cs[i];
+        bin_rs[k] = rs[i];
+    }
+    binned = true;
+}
+
+// calls f(c,r,stamp) for the circles overlapping the area
+// X,Y,W,H, cell by cell: as all the circles have the same color
+// the order does not change the result, and neighbours are
+// drawn together
+template<class F>
+void Circles::for_each_visible(int X, int Y, int W, int H, F f) const
+{
+    if ( (W <= 0) || (H <= 0) || cs.empty() )
+        return;
+    // a circle reaches its radius plus half a line
+    // width beyond the center of its cell
+    int m = radii.rbegin()->first+stamp_width;
+    int x0 = max(0,(X-m-grid_tl.x)/cell), x1 = min(cols-1,(X+W+m-grid_tl.x)/cell);
+    int y0 = max(0,(Y-m-grid_tl.y)/cell), y1 = min(rows-1,(Y+H+m-grid_tl.y)/cell);
+    // scatter plots mostly use one radius
+    int last = -1;
+    const vector<Span>* stamp = nullptr;
+    for (int y=y0; y <= y1; y++)
+        for (int x=x0; x <= x1; x++)
+            for (size_t k=first[size_t(y)*cols+x]; k < first[size_t(y)*cols+x+1]; k++)
+            {
+                Point c = bin_cs[k];
+                int r = bin_rs[k]+stamp_width;
+                if ( (c.x+r < X) || (c.x-r >= X+W) || (c.y+r < Y) || (c.y-r >= Y+H) )
+                    continue;
+                if (bin_rs[k] != last)
+                {
+                    last = bin_rs[k];
+                    stamp = &stamps.find(last)->second;
+                }
+                f(c,last,*stamp);
+            }
+}
+
+// all the visible circles in one batch of rectangles
+void Circles::draw_shape()
+{
+    update_caches();
+    pair<Point,Point> box = get_render_box();
+    int X, Y, W, H;
+    fl_clip_box(box.first.x,box.first.y,box.second.x-box.first.x,
+                box.second.y-box.first.y,X,Y,W,H);
+    Rect_batch b;
+    for_each_visible(X,Y,W,H,[&](Point c, int r, const vector<Span>& stamp) {
+        int dx = c.x-r, dy = c.y-r;
+        for (auto& s : stamp)
+        {
+            int y = s.y+dy;
+            int x0 = max(s.x0+dx,X), x1 = min(s.x1+dx,X+W);
+            if ( (y >= Y) && (y < Y+H) && (x0 < x1) )
+                b.add(x0,y,x1-x0,1);
+        }
+    });
+    count_work(Counter_type::draw_calls,this,b.finish());
+}
+
+// the visible circles stamped into the raster
+void Circles::render_shape(Raster& r) const
+{
+    update_caches();
+    pair<Point,Point> box = get_render_box();
+    int X, Y, W, H;
+    r.clip_box(box.first.x,box.first.y,box.second.x-box.first.x,
+               box.second.y-box.first.y,X,Y,W,H);
+    for_each_visible(X,Y,W,H,[&](Point c, int rad, const vector<Span>& stamp) {
+        r.spans(stamp.data(),stamp.size(),c.x-rad,c.y-rad);
+    });
+}
+
 //
 // Ellipse
 //
@@ -728,6 +1535,13 @@ void Ellipse::move_shape(int dx,int dy)
     resize_widget(Point{c.x-a,c.y-b},Point{c.x+a,c.y+b});
 }
 
+void Ellipse::render_shape(Raster& r) const
+{
+    Point tl = get_tl();
+    Point br = get_br();
+    r.arc(tl.x,tl.y,br.x-tl.x,br.y-tl.y);
+}
+
 //
 // Marked polyline
 //
@@ -752,6 +1566,27 @@ void Marked_polyline::draw_shape()
     Open_polyline::draw_shape();
 }
 
+void Marked_polyline::render_shape(Raster& r) const
+{
+    render_text(r);
+    Open_polyline::render_shape(r);
+}
+
+// every marker is drawn with its bottom left corner at
+// a point, the widget area holds all the points
+pair<Point,Point> Marked_polyline::get_render_box() const
+{
+    pair<Point,Point> b = Open_polyline::get_render_box();
+    if (empty_points() || empty_marks())
+        return b;
+    int w = 0;
+    for (auto& mrk : m)
+        w = max(w,Raster::text_width(mrk,get_fontsize()));
+    grow_box(b,Point{get_tl().x,get_tl().y-Raster::text_height(get_fontsize())},
+               Point{get_br().x+w,get_br().y+1});
+    return b;
+}
+
 void Marked_polyline::resize_widget()
 {
     // resize the open polyline first
@@ -771,6 +1606,7 @@ void Marked_polyline::resize_widget()
         {
             // update dx,dy,w,h for every marker text
             fl_text_extents(m[i].c_str(),x,y,w,h);
+            count_work(Counter_type::text_extents,this);
             
             // top left corner of enclosing rectangle of the marker text
             update_tl_br(Point{get_point(i).x+x,get_point(i).y+y});
@@ -781,6 +1617,7 @@ void Marked_polyline::resize_widget()
     {
         // same marker for all points
         fl_text_extents(m[0].c_str(),x,y,w,h);
+        count_work(Counter_type::text_extents,this);
         for (size_t i=0; i < get_nb_points(); i++)
         {
             // top left corner of enclosing rectangle of the marker text
@@ -806,6 +1643,19 @@ void Marked_polyline::draw_text()
     else throw runtime_error("Marked_polyline::draw_text(): Unequal number of points and markers!");
 }
 
+void Marked_polyline::render_text(Raster& r) const
+{
+    if (get_nb_points() == get_nb_marks())
+        // different markers for every point
+        for (size_t i=0; i < get_nb_points(); i++)
+            r.draw(m[i],get_point(i).x,get_point(i).y);
+    else if (get_nb_marks() == 1)
+        // same marker for all points
+        for (size_t i=0; i < get_nb_points(); i++)
+            r.draw(m[0],get_point(i).x,get_point(i).y);
+    else throw runtime_error("Marked_polyline::render_text(): Unequal number of points and markers!");
+}
+
 
 // getter and setter methods
 void Marked_polyline::set_mark(size_t i, string mrk)
@@ -829,26 +1679,120 @@ void Marks::draw_shape()
     restore_fl_font();
 }
 
+void Marks::render_shape(Raster& r) const
+{
+    // only draw marks
+    render_text(r);
+}
+
 //
 // Image
 //
 
 // constructor
-Image::Image(Point pos, string name) : fn{name}
-{
-    fl_register_images();
-    img = Fl_Shared_Image::get(fn.c_str());
-    switch ( img->fail() ) {
-        case Fl_Image::ERR_NO_IMAGE:
-            throw runtime_error("Image::Image(): File " + fn + " not found!");
-        case Fl_Image::ERR_FILE_ACCESS:
-            throw runtime_error("Image::Image(): File " + fn + " access error!");
-        case Fl_Image::ERR_FORMAT:
-            throw runtime_error("Image::Image(): File " + fn + " format error!");
+Image::Image(Point pos, string name, Load_type l) : fn{name}
+{
+    int w = 0, h = 0;
+    if ( (l == Load_type::asynchronous) && probe_image_size(fn,w,h) )
+    {
+        // the placeholder has the final size
+        resize_widget(pos,Point{pos.x+w,pos.y+h});
+        // the callback can outlive the image
+        waiting = make_shared<Image*>(this);
+        Image_cache::instance().get_async(fn,[p = waiting](Fl_Shared_Image* i, const string& e) {
+            if (*p) (*p)->loaded(i,e);
+            else if (i) Image_cache::instance().release(i);
+        });
+        return;
     }
+    // decoded once, shared with the other images of the same file
+    img = Image_cache::instance().get(fn);
     resize_widget(pos,Point{pos.x+img->w(),pos.y+img->h()});
 }
 
+// virtual destructor
+Image::~Image()
+{
+    if (waiting) *waiting = nullptr;
+    for (auto c : copies) delete c;
+    delete mips;
+    if (img) Image_cache::instance().release(img);
+}
+
+// scale the image, the last scaled copies are kept
+// so that going back to a previous size costs nothing;
+// the copy is made when the image is drawn next
+void Image::scale(int w, int h)
+{
+    {
+        lock_guard<mutex> lock{cache_mutex};
+        sw = w;
+        sh = h;
+        cpy = nullptr;
+    }
+    resize_widget(get_tl(),Point{get_tl().x+w,get_tl().y+h});
+}
+
+// scaled copies filtered from the nearest level of a mip
+// pyramid instead of the full image
+void Image::use_mipmaps(bool on)
+{
+    lock_guard<mutex> lock{cache_mutex};
+    mipmaps = on;
+    if (!on)
+    {
+        delete mips;
+        mips = nullptr;
+    }
+}
+
+// the copy of size sw x sh, made if not yet there; the tiles
+// of one render wait for the first one to make it and share it
+Fl_Image* Image::scaled() const
+{
+    lock_guard<mutex> lock{cache_mutex};
+    if (cpy || !img || (sw <= 0) || (sh <= 0))
+        return cpy;
+    if (mipmaps && !mips)
+        mips = new Mip_pyramid{img};
+    auto i = find_if(copies.begin(),copies.end(),
+                     [this](Fl_Image* c) { return (c->w() == sw) && (c->h() == sh); });
+    if (i != copies.end())
+        rotate(copies.begin(),i,i+1);
+    else
+    {
+        copies.insert(copies.begin(),mips ? mips->scale(sw,sh) : scale_image(img,sw,sh));
+        if (copies.size() > max_copies)
+        {
+            delete copies.back();
+            copies.pop_back();
+        }
+    }
+    cpy = copies.front();
+    return cpy;
+}
+
+// the decoded pixels of an asynchronous image, or the reason
+// why there are none; only the area of the placeholder is drawn again
+void Image::loaded(Fl_Shared_Image* i, const string& e)
+{
+    waiting.reset();
+    if (!i)
+    {
+        error = e.empty() ? "Image::loaded(): File " + fn + " not decoded!" : e;
+        if (window())
+            window()->damage(FL_DAMAGE_ALL,get_tl().x,get_tl().y,get_w(),get_h());
+        return;
+    }
+    img = i;
+    // the header probe and the decoder can disagree
+    if ( (sw <= 0) && (orig.x == 0) && (orig.y == 0) &&
+         ((img->w() != get_w()) || (img->h() != get_h())) )
+        resize_widget(get_tl(),Point{get_tl().x+img->w(),get_tl().y+img->h()});
+    if (window())
+        window()->damage(FL_DAMAGE_ALL,get_tl().x,get_tl().y,get_w(),get_h());
+}
+
 // set visible area
 void Image::set_mask(Point o, int w, int h)
 {
@@ -859,7 +1803,27 @@ void Image::set_mask(Point o, int w, int h)
 // overridden member methods
 void Image::draw_shape()
 {
-    if (cpy) cpy->draw(get_tl().x,get_tl().y);
+    if (!img)
+    {
+        // placeholder until the pixels are decoded
+        fl_color(FL_LIGHT2);
+        fl_rectf(get_tl().x,get_tl().y,get_w(),get_h());
+        fl_color(has_failed() ? FL_RED : FL_DARK3);
+        fl_rect(get_tl().x,get_tl().y,get_w(),get_h());
+        if (has_failed())
+        {
+            // crossed out, with the error inside the box
+            fl_line(get_tl().x,get_tl().y,get_tl().x+get_w()-1,get_tl().y+get_h()-1);
+            fl_line(get_tl().x,get_tl().y+get_h()-1,get_tl().x+get_w()-1,get_tl().y);
+            fl_push_clip(get_tl().x,get_tl().y,get_w(),get_h());
+            set_fl_font();
+            fl_color(FL_BLACK);
+            fl_draw(error.c_str(),get_tl().x+2,get_tl().y+fl_height()-fl_descent()+2);
+            restore_fl_font();
+            fl_pop_clip();
+        }
+    }
+    else if (Fl_Image* c = scaled()) c->draw(get_tl().x,get_tl().y);
     else img->draw(get_tl().x,get_tl().y,get_w(),get_h(),orig.x,orig.y);
 }
 
@@ -870,6 +1834,45 @@ void Image::move_shape(int dx,int dy)
                  get_tl().y+dy+get_h()});
 }
 
+void Image::render_shape(Raster& r) const
+{
+    // same choice as draw_shape: the scaled copy or
+    // the visible area of the original image
+    if (!img)
+    {
+        // placeholder until the pixels are decoded
+        r.color(FL_LIGHT2);
+        r.rectf(get_tl().x,get_tl().y,get_w(),get_h());
+        r.color(has_failed() ? FL_RED : FL_DARK3);
+        r.rect(get_tl().x,get_tl().y,get_w(),get_h());
+        if (has_failed())
+        {
+            // crossed out, with the error inside the box
+            r.line(get_tl().x,get_tl().y,get_tl().x+get_w()-1,get_tl().y+get_h()-1);
+            r.line(get_tl().x,get_tl().y+get_h()-1,get_tl().x+get_w()-1,get_tl().y);
+            r.push_clip(get_tl().x,get_tl().y,get_w(),get_h());
+            r.color(FL_BLACK);
+            r.draw(error,get_tl().x+2,get_tl().y+r.text_height()+2);
+            r.pop_clip();
+        }
+        return;
+    }
+    const Fl_Image* c = scaled();
+    const Fl_Image* src = c ? c : img;
+    Point o = c ? Point{} : orig;
+    // only RGB images carry their pixels in data()[0]
+    if ( !src || (src->count() != 1) || (src->d() < 1) || (src->d() > 4) )
+        return;
+    int w = min(get_w(),src->w()-o.x);
+    int h = min(get_h(),src->h()-o.y);
+    if ( (w <= 0) || (h <= 0) )
+        return;
+    int ld = src->ld() ? src->ld() : src->w()*src->d();
+    const uchar* buf = reinterpret_cast<const uchar*>(src->data()[0]);
+    r.draw_image(buf + size_t(o.y)*ld + size_t(o.x)*src->d(),
+                 src->d(),ld,get_tl().x,get_tl().y,w,h);
+}
+
 //
 // Function
 //
@@ -888,57 +1891,95 @@ Function::Function (Function_type f,pair<double,double> rx, double d, pair<doubl
     resize_widget();
 }
 
-// virtual destructor
-Function::~Function()
-{
-    for (auto p : vp) delete p;
-    for (auto l : labels) delete l;
-}
-
 // add a label
 void Function::add_label(double x,string txt,int dx,int dy)
 {
     // add text to the labels array
-    Text *label = new Text();
+    Text *label = label_pool.make();
     label->set_bl( Point{orig.x+int(round(x*sx))+dx, orig.y-int(round(func(x)*sy))+dy} );
     label->set_text(txt);
     labels.push_back(label);
+    if (get_win()) label->attach(get_win());
     // update widget size
     update_tl_br(Point{label->get_tl()});
     update_tl_br(Point{label->get_br()});
     resize_widget();
 }
 
+// attach the labels to the window too
+void Function::attach(Generic_window* w)
+{
+    Shape::attach(w);
+    for (auto label:labels) label->attach(w);
+}
+
 // overridden member methods
 void Function::draw_shape()
 {
-    // draw the function
-    for (size_t n=0; n<x.size()-1; n++) {
-        // only draw if the function is in the desired range
-        if ( ((y[n]<y_max) && (y[n]>y_min)) &&
-             ((y[n+1]<y_max) && (y[n+1]>y_min)) )
-            fl_line(vp[n]->x,vp[n]->y,vp[n+1]->x,vp[n+1]->y);
+    // draw the function: every run of points in
+    // the desired range is one polyline
+    size_t calls = 0;
+    for (size_t n=0; n<x.size(); ) {
+        if ( (y[n]<y_max) && (y[n]>y_min) ) {
+            size_t first = n;
+            while ( (n<x.size()) && (y[n]<y_max) && (y[n]>y_min) ) n++;
+            calls += draw_polyline(&vp[first],n-first,false);
+        }
+        else n++;
     }
+    count_work(Counter_type::draw_calls,this,calls);
     // draw the labels
     for (auto label:labels) label->draw();
 }
 
 void Function::move_shape(int dx,int dy)
 {
-    for (auto p : vp) {
-        p->x += dx;
-        p->y += dy;
+    for (auto& p : vp) {
+        p.x += dx;
+        p.y += dy;
     }
     for (auto label:labels) label->move(dx,dy);
     resize_widget(Point{get_tl().x+dx,get_tl().y+dy},
                  Point{get_br().x+dx,get_br().y+dy});
 }
 
+void Function::render_shape(Raster& r) const
+{
+    // draw the function
+    for (size_t n=1; n < x.size(); n++) {
+        // only draw if the function is in the desired range
+        if ( ((y[n-1]<y_max) && (y[n-1]>y_min)) &&
+             ((y[n]<y_max) && (y[n]>y_min)) )
+            r.line(vp[n-1].x,vp[n-1].y,vp[n].x,vp[n].y);
+    }
+    // draw the labels
+    for (auto label:labels) label->render(r);
+}
+
+// the labels are clipped to their own render box
+// inside the one of the function
+pair<Point,Point> Function::get_render_box() const
+{
+    pair<Point,Point> b = Shape::get_render_box();
+    for (auto label:labels)
+    {
+        pair<Point,Point> lb = label->get_render_box();
+        grow_box(b,lb.first,lb.second);
+    }
+    return b;
+}
+
 // calculates the function values
 void Function::calculate_y()
 {
     x_min = x_range.first;
     x_max = x_range.second;
+    // one allocation for each vector
+    if ( (x_step > 0) && (x_max > x_min) )
+    {
+        x.reserve(size_t((x_max-x_min)/x_step)+2);
+        y.reserve(x.capacity());
+    }
     double xx = x_min;
     x.push_back(xx);
     y.push_back(func(xx));
@@ -957,10 +1998,12 @@ void Function::calculate_points()
     // scale factors for the x- and y-axis
     sx = len_x / (x_max-x_min);
     sy = len_y / (y_max-y_min);
+    vp.reserve(x.size());
+    count_work(Counter_type::point_allocs,this);
     for (size_t n=0; n<x.size(); n++) {
         int xx = orig.x + int(round(x[n]*sx));
         int yy = orig.y - int(round(y[n]*sy));
-        vp.push_back(new Point{xx,yy});
+        vp.push_back(Point{xx,yy});
     }
     // set top-left and bottom-right points
     set_tl(Point{orig.x+int(round(x_min*sx)),orig.y-int(round(y_max*sy))});
@@ -990,16 +2033,26 @@ x_range{rx}, x_step{d},orig{p},len_x{lx},len_n{ln}
 void XAxis::add_label(double x,string txt,int dx,int dy)
 {
     // add text to the labels array
-    Text *label = new Text();
+    Text *label = label_pool.make();
     label->set_bl( Point{orig.x+int(round(x*sx))+dx,orig.y+dy} );
     label->set_text(txt);
     labels.push_back(label);
+    if (get_win()) label->attach(get_win());
     // update widget size
     update_tl_br(Point{label->get_tl()});
     update_tl_br(Point{label->get_br()});
     resize_widget();
 }
 
+// attach the axis line, the notches and the labels to the window too
+void XAxis::attach(Generic_window* w)
+{
+    Shape::attach(w);
+    axis.attach(w);
+    notches.attach(w);
+    for (auto label:labels) label->attach(w);
+}
+
 // overridden member methods
 void XAxis::draw_shape()
 {
@@ -1017,6 +2070,24 @@ void XAxis::move_shape(int dx,int dy)
                   Point{get_br().x+dx,get_br().y+dy});
 }
 
+void XAxis::render_shape(Raster& r) const
+{
+    axis.render(r);
+    notches.render(r);
+    for (auto label:labels) label->render(r);
+}
+
+pair<Point,Point> XAxis::get_render_box() const
+{
+    pair<Point,Point> b = Shape::get_render_box();
+    for (auto label:labels)
+    {
+        pair<Point,Point> lb = label->get_render_box();
+        grow_box(b,lb.first,lb.second);
+    }
+    return b;
+}
+
 void XAxis::set_color_shape(Color_type c)
 {
     axis.set_color(c);
@@ -1081,16 +2152,26 @@ y_range{ry}, y_step{d},orig{p},len_y{ly},len_n{ln}
 void YAxis::add_label(double y,string txt,int dx,int dy)
 {
     // add text to the labels array
-    Text *label = new Text();
+    Text *label = label_pool.make();
     label->set_bl( Point{orig.x+dx,orig.y-int(round(y*sy))+dy} );
     label->set_text(txt);
     labels.push_back(label);
+    if (get_win()) label->attach(get_win());
     // update widget size
     update_tl_br(Point{label->get_tl()});
     update_tl_br(Point{label->get_br()});
     resize_widget();
 }
 
+// attach the axis line, the notches and the labels to the window too
+void YAxis::attach(Generic_window* w)
+{
+    Shape::attach(w);
+    axis.attach(w);
+    notches.attach(w);
+    for (auto label:labels) label->attach(w);
+}
+
 // overridden member methods
 void YAxis::draw_shape()
 {
@@ -1108,6 +2189,24 @@ void YAxis::move_shape(int dx,int dy)
                   Point{get_br().x+dx,get_br().y+dy});
 }
 
+void YAxis::render_shape(Raster& r) const
+{
+    axis.render(r);
+    notches.render(r);
+    for (auto label:labels) label->render(r);
+}
+
+pair<Point,Point> YAxis::get_render_box() const
+{
+    pair<Point,Point> b = Shape::get_render_box();
+    for (auto label:labels)
+    {
+        pair<Point,Point> lb = label->get_render_box();
+        grow_box(b,lb.first,lb.second);
+    }
+    return b;
+}
+
 void YAxis::set_color_shape(Color_type c)
 {
     axis.set_color(c);
@@ -1183,6 +2282,7 @@ void Button::draw()
 
 void Button::move(int dx, int dy)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     b->resize(get_tl().x+dx,get_tl().y+dy,get_w(),get_h());
     resize_widget(Point{get_tl().x+dx,get_tl().y+dy},get_w(),get_h());
@@ -1192,6 +2292,7 @@ void Button::move(int dx, int dy)
 // setter and getter functions
 void Button::set_when(When_type w)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     fl_when = to_fl_when(w);
     show();
@@ -1199,6 +2300,7 @@ void Button::set_when(When_type w)
 
 void Button::set_button(Button_type b)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     fl_button = to_fl_button(b);
     show();
@@ -1232,6 +2334,7 @@ void In_box::draw()
 
 void In_box::move(int dx, int dy)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     in->resize(get_tl().x+dx,get_tl().y+dy,get_w(),get_h());
     resize_widget(Point{get_tl().x+dx,get_tl().y+dy},get_w(),get_h());
@@ -1266,6 +2369,7 @@ void Out_box::draw()
 
 void Out_box::move(int dx, int dy)
 {
+    count_work(Counter_type::hide_show,this);
     hide();
     out->resize(get_tl().x+dx,get_tl().y+dy,get_w(),get_h());
     resize_widget(Point{get_tl().x+dx,get_tl().y+dy},get_w(),get_h());
@@ -32,9 +32,14 @@
 #ifndef Graphics_hpp
 #define Graphics_hpp
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include <FL/Fl.H>
 #include <FL/Fl_Window.H>
@@ -48,6 +53,9 @@
 #include <FL/Fl_Input.H>
 #include <FL/Fl_Output.H>
 
+#include "Pool.hpp"
+#include "Script.hpp"
+
 namespace mathsophy::graphics
 {
 
@@ -153,6 +161,8 @@ int to_fl_font(Font_type);
 // transparency enumerations
 //
 
+// every value from 0 to 255 is an opacity,
+// Transparency_type(128) is half transparent
 enum class Transparency_type
 {
     invisible            = 0,
@@ -211,11 +221,27 @@ enum class Menu_type
     vertical    = 1
 };
 
+//
+// Image loading enumerations
+//
+
+enum class Load_type
+{
+    synchronous,    // decoded by the constructor
+    asynchronous    // decoded by a background thread
+};
+
 //
 // Generic window
 //
 
 class Widget;
+class In_box;
+class Raster;
+class Mip_pyramid;
+class Scanline_fill;
+class Triangulation;
+struct Span;
 
 class Generic_window : public Fl_Window
 {
@@ -223,7 +249,7 @@ public:
     // constructor
     Generic_window(Point tl, int w, int h, const char *l);
     // virtual destructor
-    virtual ~Generic_window() { clear(); }
+    virtual ~Generic_window();
     // attach to window
     virtual void attach(Fl_Widget& w) { add(w); }
     virtual void attach(Widget& w);
@@ -242,9 +268,14 @@ public:
     void show();
     // wait for window close
     void wait_for_exit();
+    // co_await win.timeout(ms) resumes a script after ms milliseconds
+    Event_awaiter timeout(int ms) { return Event_awaiter{ms/1000.0}; }
     // maximum x and y
     int x_max() { return w(); }
     int y_max() { return h(); }
+protected:
+    // override draw, counts the frames
+    void draw();
 };
 
 //
@@ -262,16 +293,28 @@ public:
     void attach(Fl_Widget& w);
     void attach(Widget& w);
     // callbacks
-    void next_callback(Fl_Widget *w) { button_pressed = true; }
+    void next_callback(Fl_Widget *w) {
+        // a press waited for by a script is not kept
+        if (next_waiters.empty()) button_pressed = true;
+        else next_waiters.notify();
+    }
     static void static_next_callback(Fl_Widget *w, void *win) {
         static_cast<Simple_window *>(win)->next_callback(w);
     }
-    // helper methods
+    // helper methods, the waits sleep in Fl::wait()
+    // until an event of the window is handled
     void wait_for_button();
     bool is_button_pressed();
+    // waits until the text of in changes (true) or
+    // the Next button is pressed (false)
+    bool wait_for_input_change(In_box& in);
+    // co_await win.next_pressed() resumes a script
+    // when the Next button is pressed
+    Event_awaiter next_pressed() { return Event_awaiter{next_waiters}; }
 private:
     Fl_Button* b; // the Next button that appears top right
     bool button_pressed = false;
+    Event_waiters next_waiters;   // scripts waiting for Next
 };
 
 //
@@ -286,7 +329,7 @@ public:
     // no copy assignment allowed
     Widget& operator=(const Widget&) = delete;
     // virtual destructor
-    virtual ~Widget() {}
+    virtual ~Widget();
     // virtual draw() method to be provided by
     // the derived class, overrides Fl_Widget::draw
     virtual void draw() = 0;
@@ -297,17 +340,22 @@ public:
     // overrides Fl_Widget::redraw()
     void redraw();
     // attach internal FLTK widgets to the window
-    virtual void attach(Generic_window* w) { win = w; }
+    virtual void attach(Generic_window* w);
     // getter and setter methods
     Generic_window* get_win() const { return win; }
     void set_transparency(Transparency_type t) { set_transparency_widget(t); }
     Transparency_type get_transparency() const { return trans; }
+    // opacity from 0 (invisible) to 255 (opaque, the default),
+    // values outside the range are clamped
+    void set_alpha(int a) { set_transparency(Transparency_type(clamp(a,0,255))); }
+    int get_alpha() const { return int(trans); }
     int get_w() const {return (br.x-tl.x); }
     int get_h() const {return (br.y-tl.y); }
     Point get_tl() const  { return tl; }
     Point get_br() const  { return br; }
     // helper methods
-    bool is_visible() { return (trans == Transparency_type::visible); }
+    bool is_visible() const { return (trans != Transparency_type::invisible); }
+    bool is_opaque() const  { return (trans == Transparency_type::visible); }
 protected:
     // Widget is an abstract class, no instances of Widget can be created!
     Widget() : Fl_Widget(0,0,0,0) {}
@@ -327,7 +375,7 @@ private:
     Transparency_type trans{Transparency_type::visible};
     Point tl{};                       // top-left corner
     Point br{};                       // bottom-right corner
-    Generic_window *win;              // pointer to the containing window
+    Generic_window *win{nullptr};     // pointer to the containing window
 };
 
 //
@@ -345,6 +393,13 @@ public:
     virtual ~Shape() {}
     // overrides Fl_Widget::draw()
     void draw();
+    // draws the shape into a software raster
+    // instead of the current FLTK window
+    void render(Raster& r) const;
+    // area [tl,br) the software rendering is clipped to:
+    // the widget area grown by the line width, shapes with
+    // text grow it to the size of the built-in raster font
+    virtual pair<Point,Point> get_render_box() const;
     // moves a shape relative to the current
     // top-left corner (call of redraw()
     // might be needed)
@@ -357,7 +412,9 @@ public:
     Color_type get_color() const { return to_color_type(new_color); }
     void set_style(Style_type s, int w);
     Style_type get_style() const { return to_style_type(line_style); }
+    int get_width() const { return line_width; }
     void set_font(Font_type f, int s);
+    int get_fontsize() const { return new_fontsize; }
 protected:
     // Shape is an abstract class, no instances of Shape can be created!
     Shape() : Widget() {}
@@ -365,6 +422,9 @@ protected:
     // by derived classes
     virtual void draw_shape() = 0;
     virtual void move_shape(int dx, int dy) = 0;
+    // software version of draw_shape(), shapes
+    // without one are not rendered
+    virtual void render_shape(Raster&) const {}
     // protected setter methods
     virtual void set_color_shape(Color_type c) {
         new_color = to_fl_color(c);
@@ -379,6 +439,9 @@ protected:
     void restore_fl_style();
     void set_fl_font();
     void restore_fl_font() { fl_font(old_font,old_fontsize); }
+    // FLTK cannot blend, translucent shapes are drawn
+    // with c mixed with the window background
+    Fl_Color to_fl_shape_color(Fl_Color c) const;
     // test method for checking resize calls
     void draw_outline();
 private:
@@ -408,11 +471,12 @@ public:
     virtual ~Line() {}
     // getter and setter methods
     pair<Point,Point> get_line() const { return l; }
-    void set_line(pair<Point,Point> line) { l = line; }
+    void set_line(pair<Point,Point> line);
 protected:
     // overridden member methods
-    void draw_shape() { fl_line(l.first.x, l.first.y, l.second.x, l.second.y); }
+    void draw_shape();
     void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
 private:
     pair<Point,Point> l; // a line is a pair of points
 };
@@ -427,27 +491,29 @@ public:
     // constructors
     Lines() {}
     Lines(initializer_list< pair<Point,Point> > lst) {
+        vl.reserve(lst.size());
         for (auto line : lst) add_line(line);
     }
     // virtual destructor
-    virtual ~Lines() { for (auto l: vl) delete l; }
+    virtual ~Lines() {}
     // add a line to the vector of lines
     void add_line(pair<Point,Point> line);
     // remove the i-th line
     void remove_line(size_t i);
     // getter and setter methods
-    pair<Point,Point> get_line(size_t i) const { return *vl.at(i); }
+    pair<Point,Point> get_line(size_t i) const { return vl.at(i); }
     void set_line(size_t i, pair<Point,Point> line);
     // helper methods
     size_t get_nb_lines() const { return vl.size(); }
     bool empty_lines() const { return vl.empty(); }
 protected:
     // overridden member methods
-    void draw_shape() { for (auto l: vl) fl_line(l->first.x, l->first.y, l->second.x, l->second.y); }
+    void draw_shape();
     void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
     void resize_widget();
 private:
-    vector< pair<Point,Point>* > vl; // vector of lines where a line is
+    vector< pair<Point,Point> > vl;  // vector of lines where a line is
                                      // defined by a pair of points
 };
 
@@ -461,27 +527,33 @@ public:
     // constructors
     Open_polyline() {}
     Open_polyline(initializer_list<Point> lst) {
+        vp.reserve(lst.size());
         for (auto pnt : lst) add_point(pnt);
     }
     // virtual destructor
-    virtual ~Open_polyline()        { for (auto pnt: vp) delete pnt; }
+    virtual ~Open_polyline()        {}
     // add a new point 
     void add_point(Point p);
     // remove the i-th point
     void remove_point(size_t i);
     // getter and setter methods
-    Point get_point(size_t i) const { return *vp.at(i);  }
+    Point get_point(size_t i) const { return vp.at(i);   }
     void set_point(size_t i, Point pnt);
     // helper methods
     size_t get_nb_points() const    { return vp.size();  }
     bool empty_points() const       { return vp.empty(); }
 protected:
+    // all the points, for drawing them at once
+    const vector<Point>& get_points() const { return vp; }
+    // called after any change of the points
+    virtual void points_changed()   {}
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
     void resize_widget();
 private:
-    vector<Point*> vp; // vector of points to be connected
+    vector<Point> vp;  // vector of points to be connected
 };
 
 //
@@ -494,10 +566,27 @@ public:
     // use the constructors of Open_polyline
     using Open_polyline::Open_polyline;
     // virtual destructor
-    virtual ~Closed_polyline() {}
+    virtual ~Closed_polyline();
+    // the inside as triangles, three point indices each, computed
+    // at the first request after a change of the points; this and
+    // the queries below assume that no two sides cross
+    const vector<uint32_t>& get_triangles() const;
+    double get_area() const;
+    Point  get_centroid() const;
+    // p inside the polyline or on it
+    bool contains(Point p) const;
 protected:
     // redefine Open_polyline::draw_shape
     void draw_shape();
+    void render_shape(Raster& r) const;
+    void points_changed();
+    // guards the results kept until the points
+    // change, tiles may be rendered concurrently
+    mutable mutex cache_mutex;
+private:
+    mutable Triangulation *tri{nullptr}; // triangles of the inside
+    // helper methods
+    const Triangulation& get_triangulation() const;
 };
 
 //
@@ -510,15 +599,31 @@ public:
     // use the constructors of Closed_polyline
     using Closed_polyline::Closed_polyline;
     // virtual destructor
-    virtual ~Polygon() {}
+    virtual ~Polygon();
+    // getter and setter methods
+    void set_outline(bool flag) { outline = flag; }
+    bool get_outline() const    { return outline; }
+    void set_filled(bool flag)  { filled = flag;  }
+    bool get_filled() const     { return filled;  }
+    // detects if there is an intersection
+    bool intersect() const;
 protected:
     // redefine Closed_polyline::draw_shape
     void draw_shape();
+    void render_shape(Raster& r) const;
+    void points_changed();
 private:
-    // detects if there is an intersection
-    bool intersect();
+    bool outline{true};                 // outline must be drawn
+    bool filled{false};                 // inside must be color filled
+    // results kept until the points change
+    mutable bool checked{false};        // intersections already searched
+    mutable bool simple{false};         // no intersections found
+    mutable Scanline_fill *fill{nullptr}; // spans of the inside
+    // helper methods
+    bool is_simple() const;
+    const Scanline_fill& get_fill() const;
     // given 2 lines tests for intersection
-    bool lines_intersect(Point&,Point&,Point&,Point&);
+    static bool lines_intersect(Point&,Point&,Point&,Point&);
 };
 
 //
@@ -542,6 +647,7 @@ protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
 private:
     bool outline{true}; // outline must be drawn
     bool filled{true};  // inside must be color filled
@@ -567,10 +673,13 @@ public:
     string get_text(void) const { return t; }
     void   set_bl(Point p);
     Point  get_bl() const { return bl; }
+    // overrides Shape::get_render_box()
+    pair<Point,Point> get_render_box() const;
 protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
     // resize according to text size
     void resize_text();
 private:
@@ -600,11 +709,71 @@ protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
 private:
     Point c{}; // center
     int r{0};  // radius
 };
 
+//
+// Circles
+//
+
+// many circles sharing one style, e.g. the points of a scatter
+// plot: centers and radii are stored in two arrays instead of
+// one widget each, every radius is drawn from a stamp of spans
+// computed once, and the circles are binned into a grid so that
+// only the cells of the visible area are visited
+class Circles : public Shape
+{
+public:
+    // constructor
+    Circles();
+    // virtual destructor
+    virtual ~Circles();
+    // add a circle
+    void add_circle(Point c, int r);
+    // remove the i-th circle
+    void remove_circle(size_t i);
+    // getter and setter methods
+    Point get_center(size_t i) const { return cs.at(i); }
+    int   get_radius(size_t i) const { return rs.at(i); }
+    void  set_circle(size_t i, Point c, int r);
+    void  set_filled(bool flag);
+    bool  get_filled() const { return filled; }
+    // helper methods
+    size_t get_nb_circles() const { return cs.size();  }
+    bool   empty_circles() const  { return cs.empty(); }
+    void   reserve(size_t n)      { cs.reserve(n); rs.reserve(n); }
+protected:
+    // overridden member methods
+    void draw_shape();
+    void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
+    void resize_widget();
+private:
+    vector<Point> cs;           // centers
+    vector<int> rs;             // radii
+    bool filled{false};         // inside must be color filled
+    map<int,size_t> radii;      // number of circles of each radius
+    // results kept until the circles change
+    mutable mutex cache_mutex;  // tiles may be rendered concurrently
+    mutable map< int, vector<Span> > stamps; // pixels of each radius
+    mutable int stamp_width{0}; // line width the stamps were made for
+    mutable bool binned{false}; // circles binned into the grid
+    mutable Point grid_tl;      // top-left corner of the grid
+    mutable int cell{1};        // size of a cell
+    mutable int cols{0};        // number of cells
+    mutable int rows{0};
+    mutable vector<uint32_t> first; // the circles of cell c are the
+    mutable vector<Point> bin_cs;   // copies [first[c],first[c+1])
+    mutable vector<int> bin_rs;     // of cs and rs, cell by cell
+    // helper methods
+    void changed();
+    void update_caches() const;
+    template<class F> void for_each_visible(int X, int Y, int W, int H, F f) const;
+};
+
 //
 // Ellipse
 //
@@ -629,6 +798,7 @@ protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
 private:
     Point c{}; // center
     int  a{0}; // width
@@ -661,12 +831,16 @@ public:
     // helper methods
     size_t get_nb_marks() const     { return m.size(); }
     bool empty_marks() const { return m.empty(); }
+    // overrides Shape::get_render_box()
+    pair<Point,Point> get_render_box() const;
 protected:
     // overridden member methods
     void draw_shape();
+    void render_shape(Raster& r) const;
     void resize_widget();
     // draw all the text markers
     void draw_text();
+    void render_text(Raster& r) const;
 private:
     vector<string> m; // vector of marks
 };
@@ -687,6 +861,7 @@ public:
 protected:
     // overridden member methods
     void draw_shape();
+    void render_shape(Raster& r) const;
 };
 
 //
@@ -709,27 +884,47 @@ public:
 class Image : public Shape
 {
 public:
-    // constructors
-    Image(Point pos, string name);
+    // constructors, an asynchronous image is drawn as a
+    // placeholder box until its pixels are decoded, and as
+    // a crossed out box with the error if they cannot be
+    Image(Point pos, string name, Load_type l = Load_type::synchronous);
     // virtual destructor
-    virtual ~Image() { if (img) img->release(); }
+    virtual ~Image();
     // set visible area
     void set_mask(Point o, int w, int h);
-    // scale the image
-    void scale(int w, int h) { cpy = img->copy(w,h);
-        resize_widget(get_tl(),Point{get_tl().x+w,get_tl().y+h});
-    }
+    // scale the image, the last scaled copies are kept
+    // so that going back to a previous size costs nothing;
+    // the copy is made when the image is drawn next
+    void scale(int w, int h);
+    // scaled copies filtered from the nearest level of a mip
+    // pyramid instead of the full image, for zooming large images
+    void use_mipmaps(bool on);
     // getter and setter methods
     Point get_orig() const { return orig; }
+    bool is_loaded() const { return img != nullptr; }
+    bool has_failed() const { return !error.empty(); }
+    string get_error() const { return error; }
 protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
 private:
     Fl_Shared_Image *img{nullptr}; // FLTK image pointer
-    Fl_Image *cpy{nullptr};        // scaled image
+    mutable mutex cache_mutex;          // tiles may be rendered concurrently
+    mutable Fl_Image *cpy{nullptr};     // scaled image
+    mutable vector<Fl_Image*> copies;   // scaled copies, most recent first
+    static const size_t max_copies{4};
+    mutable Mip_pyramid *mips{nullptr}; // halvings of img, if enabled
+    bool mipmaps{false};           // use a mip pyramid
+    int sw{0}, sh{0};              // scaled size, 0 if not scaled
     string fn{};                   // file name
     Point orig{};                  // origin
+    shared_ptr<Image*> waiting{};  // this image while being decoded
+    string error{};                // why an asynchronous image failed
+    // helper methods
+    Fl_Image* scaled() const;
+    void loaded(Fl_Shared_Image* i, const string& e);
 };
 
 //
@@ -742,16 +937,21 @@ public:
     // constructor
     Function (Function_type f,pair<double,double> rx, double d, pair<double,double> ry,Point p, int lx, double ar=1);
     // virtual destructor
-    virtual ~Function();
+    virtual ~Function() {}
     // add a label
     void add_label(double x,string txt,int dx=0,int dy=0);
+    // attach the labels to the window too
+    void attach(Generic_window* w);
     // getter and setter methods
     Point get_orig() const { return orig; }
     vector<Text*> labels; // public vector of labels
+    // overrides Shape::get_render_box()
+    pair<Point,Point> get_render_box() const;
 protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
     // calculates the function values
     void calculate_y();
     // calculate actual points to be drawn
@@ -760,7 +960,8 @@ private:
     Function_type func;                // function
     vector<double> y;                  // function values
     vector<double> x;                  // domain values
-    vector<Point*> vp;                 // actual points to be drawn
+    vector<Point> vp;                  // actual points to be drawn
+    Pool<Text> label_pool;             // storage of the labels
     pair<double,double> x_range{0,0};  // [x_min,x_max)
     pair<double,double> y_range{0,0};  // (y_min,y_max)
     Point orig{};                      // origin
@@ -786,9 +987,11 @@ public:
     // constructor
     XAxis(pair<double,double> rx, double d, Point p, int lx, int ln=5);
     // virtual destructor
-    virtual ~XAxis() { for (auto l : labels) delete l; }
+    virtual ~XAxis() {}
     // add label
     void add_label(double x, string txt, int dx=0, int dy=0);
+    // attach the axis line, the notches and the labels to the window too
+    void attach(Generic_window* w);
     // getter and setter methods
     Point get_orig() const { return orig; }
     // helper methods
@@ -796,10 +999,13 @@ public:
     vector<Text*> labels;   // vector of labels
     Lines notches;          // lines representing the notches
     Line axis;              // single axis line
+    // overrides Shape::get_render_box()
+    pair<Point,Point> get_render_box() const;
 protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
     void set_color_shape(Color_type c);
     // determine notches positions
     void calculate_x();
@@ -815,6 +1021,7 @@ private:
     double x_max{0};                   // maximum abscissa
     double x_step{0};                  // x increment
     double sx{0};                      // scale factor for the x-axis
+    Pool<Text> label_pool;             // storage of the labels
 };
 
 //
@@ -827,9 +1034,11 @@ public:
     // constructor
     YAxis(pair<double,double> ry, double d, Point p, int ly, int ln=5);
     // virtual destructor
-    virtual ~YAxis() { for (auto l : labels) delete l; }
+    virtual ~YAxis() {}
     // add label
     void add_label(double y,string txt,int dx=0,int dy=0);
+    // attach the axis line, the notches and the labels to the window too
+    void attach(Generic_window* w);
     // getter and setter methods
     Point get_orig() const { return orig; }
     // helper methods
@@ -837,10 +1046,13 @@ public:
     vector<Text*> labels;   // vector of labels
     Lines notches;          // lines representing the notches
     Line axis;              // single axis line
+    // overrides Shape::get_render_box()
+    pair<Point,Point> get_render_box() const;
 protected:
     // overridden member methods
     void draw_shape();
     void move_shape(int dx, int dy);
+    void render_shape(Raster& r) const;
     void set_color_shape(Color_type c);
     // determine notches positions
     void calculate_y();
@@ -856,6 +1068,7 @@ private:
     double y_max{0};                   // maximum ordinate
     double y_step{0};                  // y increment
     double sy{0};                      // scale factor for the y-axis
+    Pool<Text> label_pool;             // storage of the labels
 };
 
 //
@@ -908,7 +1121,7 @@ public:
     static void static_input_callback(Fl_Widget *fl_w, void *widget) {
         static_cast<In_box*>(widget)->input_callback();
     }
-    void input_callback() { in_text = string{in->value()}; }
+    void input_callback() { in_text = string{in->value()}; changes++; change_waiters.notify(); }
     // show button
     void show() { set_transparency(Transparency_type::visible); }
     // hide button
@@ -921,11 +1134,17 @@ public:
     // setter and getter functions
     string get_input_text()    { return in_text; }
     int    get_input_integer() { return stoi(in_text); }
+    size_t get_changes() const { return changes; }
+    // co_await in_box.changed() resumes a script
+    // when the text changes
+    Event_awaiter changed() { return Event_awaiter{change_waiters}; }
     void   set_label(string s) { text = s; }
     string get_label() const   { return text; }
 private:
     Fl_Input *in{nullptr};  // pointer to FLTK input box
     string in_text{};       // input text
+    size_t changes{0};      // number of callbacks so far
+    Event_waiters change_waiters; // scripts waiting for a change
     string text{};          // label
 };
 
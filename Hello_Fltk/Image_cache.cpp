@@ -0,0 +1,614 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Image_cache.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Image_cache.hpp"
+#include "Mutation_queue.hpp"
+#include "Thread_pool.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <FL/Fl.H>
+#include <FL/Fl_Image.H>
+#include <FL/Fl_Shared_Image.H>
+#include <FL/Fl_BMP_Image.H>
+#include <FL/Fl_GIF_Image.H>
+#include <FL/Fl_JPEG_Image.H>
+#include <FL/Fl_PNG_Image.H>
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+//
+// Image formats
+//
+
+enum class Format_type { unknown, png, jpeg, gif, bmp };
+
+uint32_t be16(const uchar* p) { return (uint32_t(p[0]) << 8) | p[1]; }
+uint32_t be32(const uchar* p) { return (be16(p) << 16) | be16(p+2); }
+uint32_t le16(const uchar* p) { return (uint32_t(p[1]) << 8) | p[0]; }
+uint32_t le32(const uchar* p) { return (le16(p+2) << 16) | le16(p); }
+
+// format and size from the first bytes of a file, the JPEG size
+// is in a frame marker which can come after the metadata
+Format_type probe(ifstream& in, int& w, int& h)
+{
+    uchar b[26]{};
+    in.read(reinterpret_cast<char*>(b),sizeof(b));
+    if (in.gcount() < 10)
+        return Format_type::unknown;
+    // PNG: signature, then the IHDR chunk
+    if ( (b[0] == 0x89) && (b[1] == 'P') && (b[2] == 'N') && (b[3] == 'G') )
+    {
+        w = int(be32(b+16));
+        h = int(be32(b+20));
+        return Format_type::png;
+    }
+    // GIF: logical screen size
+    if ( (b[0] == 'G') && (b[1] == 'I') && (b[2] == 'F') )
+    {
+        w = int(le16(b+6));
+        h = int(le16(b+8));
+        return Format_type::gif;
+    }
+    // BMP: info header, negative heights are top-down images
+    if ( (b[0] == 'B') && (b[1] == 'M') && (in.gcount() == sizeof(b)) )
+    {
+        w = int(le32(b+18));
+        h = abs(int(le32(b+22)));
+        return Format_type::bmp;
+    }
+    // JPEG: markers up to the first start of frame
+    if ( (b[0] != 0xff) || (b[1] != 0xd8) )
+        return Format_type::unknown;
+    in.clear();
+    in.seekg(2);
+    uchar m[9];
+    while ( in.read(reinterpret_cast<char*>(m),4) )
+    {
+        if (m[0] != 0xff)
+            return Format_type::unknown;
+        // SOF0 to SOF15, except DHT, JPG and DAC
+        if ( (m[1] >= 0xc0) && (m[1] <= 0xcf) && (m[1] != 0xc4) && (m[1] != 0xc8) && (m[1] != 0xcc) )
+        {
+            if ( !in.read(reinterpret_cast<char*>(m+4),5) )
+                return Format_type::unknown;
+            h = int(be16(m+5));
+            w = int(be16(m+7));
+            return Format_type::jpeg;
+        }
+        in.seekg(int(be16(m+2))-2,ios::cur);
+    }
+    return Format_type::unknown;
+}
+
+// message of a file fn which could not be loaded by method
+string load_error(const string& method, const string& fn, int err)
+{
+    switch (err) {
+        case Fl_Image::ERR_NO_IMAGE:    return method + ": File " + fn + " not found!";
+        case Fl_Image::ERR_FILE_ACCESS: return method + ": File " + fn + " access error!";
+        default:                        return method + ": File " + fn + " format error!";
+    }
+}
+
+// decoded pixels of file fn, nullptr if its format cannot
+// be decoded here, throws if fn cannot be read or decoded;
+// the decoders only touch their own image, so they can run
+// on any thread
+Fl_Image* decode(const string& fn)
+{
+    ifstream in{fn,ios::binary};
+    if (!in)
+        throw runtime_error(load_error("Image_cache::get_async()",fn,Fl_Image::ERR_NO_IMAGE));
+    int w = 0, h = 0;
+    Format_type f = probe(in,w,h);
+    in.close();
+    Fl_Image* img = nullptr;
+    switch (f) {
+        case Format_type::png:  img = new Fl_PNG_Image(fn.c_str()); break;
+        case Format_type::jpeg: img = new Fl_JPEG_Image(fn.c_str()); break;
+        case Format_type::gif:  img = new Fl_GIF_Image(fn.c_str()); break;
+        case Format_type::bmp:  img = new Fl_BMP_Image(fn.c_str()); break;
+        case Format_type::unknown: return nullptr;
+    }
+    int err = img->fail();
+    if ( err || (img->w() <= 0) || (img->h() <= 0) )
+    {
+        delete img;
+        throw runtime_error(load_error("Image_cache::get_async()",fn,err));
+    }
+    return img;
+}
+
+// shared image made of pixels decoded by a background thread,
+// registered with FLTK like the images of Fl_Shared_Image::get()
+class Decoded_image : public Fl_Shared_Image
+{
+public:
+    Decoded_image(const string& fn, Fl_Image* img) : Fl_Shared_Image(fn.c_str(),img)
+    {
+        // img is deleted with the shared image
+        alloc_image_ = 1;
+        add();
+    }
+};
+
+//
+// Disk cache
+//
+
+// a 48 bytes header, the path of the image file, then the
+// pixels from the next multiple of 64 bytes, row after row
+struct Disk_header
+{
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t path_size;
+    uint64_t file_size;     // of the image file
+    int64_t file_time;      // modification time of the image file
+    uint64_t reserved;
+};
+
+const char disk_magic[8] = {'H','F','R','G','B','A','0','1'};
+
+// key of an image file: absolute path, modification time and size
+struct Disk_key
+{
+    string path;
+    uint64_t size;
+    int64_t time;
+};
+
+bool disk_key(const string& fn, Disk_key& k)
+{
+    error_code e;
+    k.path = filesystem::absolute(fn,e).string();
+    k.size = e ? 0 : uint64_t(filesystem::file_size(k.path,e));
+    k.time = e ? 0 : int64_t(filesystem::last_write_time(k.path,e).time_since_epoch().count());
+    return !e;
+}
+
+// the cache file of key k in directory dir, named after the path
+// only: the size and time are checked against the header, so that
+// a changed image file overwrites its stale pixels instead of
+// leaving them behind under another name
+string disk_file(const string& dir, const Disk_key& k)
+{
+    size_t h = hash<string>{}(k.path);
+    char name[32];
+    snprintf(name,sizeof(name),"%016llx.rgba",(unsigned long long)h);
+    return (filesystem::path{dir} / name).string();
+}
+
+size_t disk_offset(size_t path_size)
+{
+    return (sizeof(Disk_header) + path_size + 63) & ~size_t(63);
+}
+
+// pixels of a cache file mapped into memory, the
+// mapping is released with the image
+class Mapped_image : public Fl_RGB_Image
+{
+public:
+    Mapped_image(void* m, size_t n, const uchar* px, int w, int h, int d)
+        : Fl_RGB_Image(px,w,h,d), map{m}, map_size{n} {}
+    ~Mapped_image() { munmap(map,map_size); }
+private:
+    void* map;
+    size_t map_size;
+};
+
+// the decoded pixels of file fn mapped from the disk cache,
+// nullptr if not there or if the file has changed (the entry
+// is then overwritten by store_decoded())
+Fl_Image* load_decoded(const string& dir, const string& fn)
+{
+    Disk_key k;
+    if ( !disk_key(fn,k) )
+        return nullptr;
+    int fd = open(disk_file(dir,k).c_str(),O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    Disk_header hd;
+    off_t n = lseek(fd,0,SEEK_END);
+    bool valid = (pread(fd,&hd,sizeof(hd),0) == ssize_t(sizeof(hd))) &&
+                 (memcmp(hd.magic,disk_magic,sizeof(disk_magic)) == 0) &&
+                 (hd.file_size == k.size) && (hd.file_time == k.time) &&
+                 (hd.path_size == k.path.size()) && (hd.depth >= 1) && (hd.depth <= 4) &&
+                 (size_t(n) == disk_offset(hd.path_size) + size_t(hd.width)*hd.height*hd.depth);
+    void* m = valid ? mmap(nullptr,size_t(n),PROT_READ,MAP_SHARED,fd,0) : MAP_FAILED;
+    close(fd);
+    if (m == MAP_FAILED)
+        return nullptr;
+    // two paths with the same hash
+    const char* path = static_cast<const char*>(m) + sizeof(hd);
+    if (k.path.compare(0,string::npos,path,hd.path_size) != 0)
+    {
+        munmap(m,size_t(n));
+        return nullptr;
+    }
+    const uchar* px = static_cast<const uchar*>(m) + disk_offset(hd.path_size);
+    return new Mapped_image(m,size_t(n),px,int(hd.width),int(hd.height),int(hd.depth));
+}
+
+// write the decoded pixels of file fn to the disk cache,
+// false for images without accessible pixels or on errors
+bool store_decoded(const string& dir, const string& fn, const Fl_Image* img)
+{
+    Disk_key k;
+    if ( (img->count() != 1) || (img->d() < 1) || (img->d() > 4) || !img->data() || !disk_key(fn,k) )
+        return false;
+    error_code e;
+    filesystem::create_directories(dir,e);
+    string cf = disk_file(dir,k);
+    // written under a temporary name, so that another process
+    // never maps a partial file, and unique within the process
+    // as get() and the decoding threads may write at once
+    static atomic<unsigned> serial{0};
+    string tmp = cf + "." + to_string(getpid()) + "." + to_string(serial++);
+    {
+        ofstream out{tmp,ios::binary};
+        Disk_header hd{};
+        memcpy(hd.magic,disk_magic,sizeof(disk_magic));
+        hd.width = uint32_t(img->w());
+        hd.height = uint32_t(img->h());
+        hd.depth = uint32_t(img->d());
+        hd.path_size = uint32_t(k.path.size());
+        hd.file_size = k.size;
+        hd.file_time = k.time;
+        out.write(reinterpret_cast<const char*>(&hd),sizeof(hd));
+        out.write(k.path.data(),k.path.size());
+        string pad(disk_offset(k.path.size()) - sizeof(hd) - k.path.size(),'\0');
+        out.write(pad.data(),pad.size());
+        size_t row = size_t(img->w())*img->d();
+        size_t ld = img->ld() ? size_t(img->ld()) : row;
+        const char* px = img->data()[0];
+        for (int y=0; y < img->h(); y++)
+            out.write(px + y*ld,row);
+        if (!out)
+        {
+            out.close();
+            filesystem::remove(tmp,e);
+            return false;
+        }
+    }
+    filesystem::rename(tmp,cf,e);
+    return !e;
+}
+
+// a decoded file on its way to the main thread
+struct Decoded_file
+{
+    string fn;
+    Fl_Image* img;
+    bool from_disk;
+    bool to_disk;
+    string error;           // why img is nullptr, empty if not decoded here
+};
+
+}
+
+//
+// Image header probe
+//
+
+// size of the image in file fn read from its header only (PNG,
+// JPEG, GIF, BMP), false if the format is not recognized
+bool probe_image_size(const string& fn, int& w, int& h)
+{
+    ifstream in{fn,ios::binary};
+    int pw = 0, ph = 0;
+    if ( !in || (probe(in,pw,ph) == Format_type::unknown) || (pw <= 0) || (ph <= 0) )
+        return false;
+    w = pw;
+    h = ph;
+    return true;
+}
+
+//
+// Image cache statistics
+//
+
+ostream& operator<<(ostream& os, const Image_cache_stats& s)
+{
+    return os << s.hits << " hits, " << s.misses << " misses, "
+              << s.evictions << " evictions, " << s.disk_hits << " from disk, "
+              << s.resident_images
+              << " images resident (" << (s.resident_bytes >> 10) << " of "
+              << (s.budget >> 10) << " KiB)";
+}
+
+//
+// Image cache
+//
+
+Image_cache::Image_cache()
+{
+}
+
+Image_cache::~Image_cache()
+{
+    // the decoding threads are done before the images go
+    decoder.reset();
+    clear();
+}
+
+// the cache of the process
+Image_cache& Image_cache::instance()
+{
+    static Image_cache cache;
+    return cache;
+}
+
+// decoded image of file fn, every get() must be
+// paired with a release(), throws if fn cannot be read
+Fl_Shared_Image* Image_cache::get(const string& fn)
+{
+    // the image formats are registered once per process
+    static once_flag registered;
+    call_once(registered,fl_register_images);
+    
+    unique_lock<mutex> lock{m};
+    if (Fl_Shared_Image* img = find(fn))
+        return img;
+    stats.misses++;
+    // no decoding if the pixels are in the disk cache
+    if ( !disk_dir.empty() )
+        if (Fl_Image* px = load_decoded(disk_dir,fn))
+        {
+            stats.disk_hits++;
+            Fl_Shared_Image* img = new Decoded_image(fn,px);
+            add(fn,img,1);
+            return img;
+        }
+    Fl_Shared_Image* img = Fl_Shared_Image::get(fn.c_str());
+    if (!img)
+        throw runtime_error(load_error("Image_cache::get()",fn,Fl_Image::ERR_NO_IMAGE));
+    if (int err = img->fail())
+    {
+        img->release();
+        throw runtime_error(load_error("Image_cache::get()",fn,err));
+    }
+    add(fn,img,1);
+    // the image in use cannot be evicted, its pixels are written
+    // to the disk cache without holding up the other threads
+    string dir = disk_dir;
+    lock.unlock();
+    if ( !dir.empty() && store_decoded(dir,fn,img) )
+    {
+        lock_guard<mutex> relock{m};
+        stats.disk_writes++;
+    }
+    return img;
+}
+
+// same as get(), but the file is decoded by a background thread
+// and done(img,error) is called by the main thread through Fl::awake()
+void Image_cache::get_async(const string& fn, function<void(Fl_Shared_Image*,const string&)> done)
+{
+    init_fl_threads();
+    
+    unique_lock<mutex> lock{m};
+    if (Fl_Shared_Image* img = find(fn))
+    {
+        lock.unlock();
+        done(img,string{});
+        return;
+    }
+    // a file is decoded once for all its waiting callbacks
+    auto& waiting = loading[fn];
+    waiting.push_back(move(done));
+    if (waiting.size() > 1)
+        return;
+    if (!decoder)
+        decoder = make_unique<Thread_pool>(2);
+    decoder->submit([fn,dir = disk_dir] {
+        Decoded_file* d = new Decoded_file{fn,nullptr,false,false,string{}};
+        if ( !dir.empty() && (d->img = load_decoded(dir,fn)) )
+            d->from_disk = true;
+        else
+        {
+            try {
+                d->img = decode(fn);
+            } catch (const exception& e) {
+                d->error = e.what();
+            }
+            d->to_disk = d->img && !dir.empty() && store_decoded(dir,fn,d->img);
+        }
+        Fl::awake(decoded,d);
+    });
+}
+
+// Fl::awake() handler of a decoded file
+void Image_cache::decoded(void* d)
+{
+    unique_ptr<Decoded_file> file{static_cast<Decoded_file*>(d)};
+    Image_cache& cache = instance();
+    vector< function<void(Fl_Shared_Image*,const string&)> > waiting;
+    Fl_Shared_Image* img = nullptr;
+    {
+        lock_guard<mutex> lock{cache.m};
+        waiting = move(cache.loading[file->fn]);
+        cache.loading.erase(file->fn);
+        int users = int(waiting.size());
+        if (users == 0)
+        {
+            delete file->img;
+            return;
+        }
+        // a get() may have decoded the file in the meantime
+        if ( (img = cache.find(file->fn)) )
+        {
+            delete file->img;
+            cache.index[file->fn]->users += users-1;
+            cache.stats.hits += users-1;
+        }
+        else if (file->img)
+        {
+            cache.stats.misses++;
+            cache.stats.disk_hits += file->from_disk;
+            cache.stats.disk_writes += file->to_disk;
+            cache.stats.hits += users-1;
+            img = new Decoded_image(file->fn,file->img);
+            cache.add(file->fn,img,users);
+        }
+        else if ( !file->error.empty() )
+            cache.stats.misses++;
+    }
+    // only the formats without a decoder above go the synchronous
+    // way, a file which failed to decode is not decoded again
+    if ( !img && file->error.empty() )
+    {
+        try {
+            img = cache.get(file->fn);
+            for (size_t i=1; i < waiting.size(); i++) cache.get(file->fn);
+        } catch (const exception& e) {
+            file->error = e.what();
+        }
+    }
+    for (auto& done : waiting)
+        done(img,file->error);
+}
+
+// the resident image of file fn with one more user, or nullptr
+Fl_Shared_Image* Image_cache::find(const string& fn)
+{
+    auto i = index.find(fn);
+    if (i == index.end())
+        return nullptr;
+    stats.hits++;
+    lru.splice(lru.begin(),lru,i->second);
+    i->second->users++;
+    return i->second->img;
+}
+
+// make img resident with the given number of users
+void Image_cache::add(const string& fn, Fl_Shared_Image* img, int users)
+{
+    size_t bytes = size_t(img->w())*img->h()*img->d();
+    // room is made before the new image is counted
+    trim(budget > bytes ? budget-bytes : 0);
+    lru.push_front(Entry{fn,img,bytes,users});
+    index[fn] = lru.begin();
+    images[img] = lru.begin();
+    stats.resident_bytes += bytes;
+    stats.resident_images++;
+}
+
+void Image_cache::release(Fl_Shared_Image* img)
+{
+    lock_guard<mutex> lock{m};
+    auto i = images.find(img);
+    if ( (i != images.end()) && (i->second->users > 0) )
+        i->second->users--;
+    trim(budget);
+}
+
+// setter and getter methods for the byte budget
+void Image_cache::set_budget(size_t bytes)
+{
+    lock_guard<mutex> lock{m};
+    budget = bytes;
+    trim(budget);
+}
+
+size_t Image_cache::get_budget() const
+{
+    lock_guard<mutex> lock{m};
+    return budget;
+}
+
+// disk cache directory, empty if off
+void Image_cache::set_disk_cache(const string& dir)
+{
+    lock_guard<mutex> lock{m};
+    disk_dir = dir;
+}
+
+string Image_cache::get_disk_cache() const
+{
+    lock_guard<mutex> lock{m};
+    return disk_dir;
+}
+
+// statistics since the start of the process
+Image_cache_stats Image_cache::get_stats() const
+{
+    lock_guard<mutex> lock{m};
+    Image_cache_stats s = stats;
+    s.budget = budget;
+    return s;
+}
+
+// release all the images which are not in use
+void Image_cache::clear()
+{
+    lock_guard<mutex> lock{m};
+    trim(0);
+}
+
+// release unused images, least recently used first,
+// until the resident bytes fit the budget
+void Image_cache::trim(size_t bytes)
+{
+    for (auto i = lru.end(); (i != lru.begin()) && (stats.resident_bytes > bytes); )
+    {
+        --i;
+        if (i->users > 0)
+            continue;
+        stats.resident_bytes -= i->bytes;
+        stats.resident_images--;
+        stats.evictions++;
+        images.erase(i->img);
+        i->img->release();
+        index.erase(i->fn);
+        i = lru.erase(i);
+    }
+}
+
+} // namespace mathsophy::graphics
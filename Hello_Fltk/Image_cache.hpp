@@ -0,0 +1,154 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Image_cache.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Image_cache_hpp
+#define Image_cache_hpp
+
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <FL/Fl_Shared_Image.H>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+class Thread_pool;
+
+//
+// Image header probe
+//
+
+// size of the image in file fn read from its header only (PNG,
+// JPEG, GIF, BMP), false if the format is not recognized
+bool probe_image_size(const string& fn, int& w, int& h);
+
+//
+// Image cache statistics
+//
+
+struct Image_cache_stats
+{
+    size_t hits{0};            // requests served from the cache
+    size_t misses{0};          // requests which were not resident
+    size_t disk_hits{0};       // misses mapped from the disk cache
+    size_t disk_writes{0};     // decoded images written to the disk cache
+    size_t evictions{0};       // images dropped to meet the budget
+    size_t resident_bytes{0};  // decoded bytes held by the cache
+    size_t resident_images{0}; // images held by the cache
+    size_t budget{0};          // byte budget
+    double hit_rate() const { return (hits+misses) ? double(hits)/(hits+misses) : 0; }
+};
+
+ostream& operator<<(ostream& os, const Image_cache_stats& s);
+
+//
+// Image cache
+//
+
+// decoded images shared by all the Image shapes of the process:
+// an image stays resident after its last user is gone, the least
+// recently used images which are not in use are released when
+// the decoded bytes exceed the budget (images in use are never
+// released, so the budget can be exceeded while they are shown)
+class Image_cache
+{
+public:
+    // the cache of the process
+    static Image_cache& instance();
+    // no copy constructor allowed
+    Image_cache(const Image_cache&) = delete;
+    // no copy assignment allowed
+    Image_cache& operator=(const Image_cache&) = delete;
+    // decoded image of file fn, every get() must be
+    // paired with a release(), throws if fn cannot be read
+    Fl_Shared_Image* get(const string& fn);
+    void release(Fl_Shared_Image* img);
+    // same as get(), but the file is decoded by a background thread
+    // and done(img,error) is called by the main thread through
+    // Fl::awake() (right away if the image is resident), img is
+    // nullptr and error says why if fn cannot be read or decoded;
+    // must be called by the main thread
+    void get_async(const string& fn, function<void(Fl_Shared_Image*,const string&)> done);
+    // setter and getter methods for the byte budget
+    void set_budget(size_t bytes);
+    size_t get_budget() const;
+    // decoded pixels are also kept as files in directory dir, one per
+    // image path, and are mapped into memory instead of being decoded
+    // on the next runs; an entry is rewritten when the modification
+    // time or size of its image file changes;
+    // an empty dir (the default) turns the disk cache off
+    void set_disk_cache(const string& dir);
+    string get_disk_cache() const;
+    // statistics since the start of the process
+    Image_cache_stats get_stats() const;
+    // release all the images which are not in use
+    void clear();
+private:
+    Image_cache();
+    ~Image_cache();
+    struct Entry
+    {
+        string fn;                   // file name, the key
+        Fl_Shared_Image* img;        // reference owned by the cache
+        size_t bytes;                // decoded size
+        int users;                   // get() calls not yet released
+    };
+    list<Entry> lru;                 // most recently used first
+    unordered_map<string, list<Entry>::iterator> index; // entries by file name
+    unordered_map<const Fl_Shared_Image*, list<Entry>::iterator> images; // entries by image
+    size_t budget{size_t(256) << 20};// byte budget, 256 MiB
+    Image_cache_stats stats;
+    mutable mutex m;                 // get() may be called by several threads
+    // callbacks of get_async() waiting for a file being decoded
+    unordered_map<string, vector< function<void(Fl_Shared_Image*,const string&)> > > loading;
+    unique_ptr<Thread_pool> decoder; // background decoding, made at first use
+    string disk_dir{};               // disk cache directory, empty if off
+    // the resident image of file fn with one more user, or nullptr
+    Fl_Shared_Image* find(const string& fn);
+    // make img resident with the given number of users
+    void add(const string& fn, Fl_Shared_Image* img, int users);
+    // release unused images, least recently used first,
+    // until the resident bytes fit the budget
+    void trim(size_t bytes);
+    // Fl::awake() handler of a decoded file
+    static void decoded(void* d);
+};
+
+}
+#endif /* Image_cache_hpp */
@@ -0,0 +1,344 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Image_scaler.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Image_scaler.hpp"
+#include "Span_kernels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGE_SCALER_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define IMAGE_SCALER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+//
+// Row kernels
+//
+
+// both filters first combine whole source rows, which is where
+// the time goes for large reductions: these loops are vectorized,
+// the horizontal pass only touches the destination pixels
+
+// acc[i] += src[i]
+void accumulate_scalar(uint32_t* acc, const uchar* src, size_t n)
+{
+    for (size_t i=0; i < n; i++)
+        acc[i] += src[i];
+}
+
+// out[i] = a[i]*(256-f) + b[i]*f, f from 0 to 256
+void lerp_scalar(uint16_t* out, const uchar* a, const uchar* b, size_t n, unsigned f)
+{
+    for (size_t i=0; i < n; i++)
+        out[i] = uint16_t(a[i]*(256-f) + b[i]*f);
+}
+
+#if IMAGE_SCALER_X86
+
+__attribute__((target("sse2")))
+void accumulate_sse2(uint32_t* acc, const uchar* src, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i+16 <= n; i += 16)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+        __m128i lo = _mm_unpacklo_epi8(s,zero), hi = _mm_unpackhi_epi8(s,zero);
+        __m128i* p = reinterpret_cast<__m128i*>(acc+i);
+        _mm_storeu_si128(p,  _mm_add_epi32(_mm_loadu_si128(p),  _mm_unpacklo_epi16(lo,zero)));
+        _mm_storeu_si128(p+1,_mm_add_epi32(_mm_loadu_si128(p+1),_mm_unpackhi_epi16(lo,zero)));
+        _mm_storeu_si128(p+2,_mm_add_epi32(_mm_loadu_si128(p+2),_mm_unpacklo_epi16(hi,zero)));
+        _mm_storeu_si128(p+3,_mm_add_epi32(_mm_loadu_si128(p+3),_mm_unpackhi_epi16(hi,zero)));
+    }
+    accumulate_scalar(acc+i,src+i,n-i);
+}
+
+__attribute__((target("sse2")))
+void lerp_sse2(uint16_t* out, const uchar* a, const uchar* b, size_t n, unsigned f)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(short(256-f)), wb = _mm_set1_epi16(short(f));
+    size_t i = 0;
+    for (; i+16 <= n; i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va,zero),wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb,zero),wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va,zero),wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb,zero),wb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out+i+8),hi);
+    }
+    lerp_scalar(out+i,a+i,b+i,n-i,f);
+}
+
+__attribute__((target("avx2")))
+void accumulate_avx2(uint32_t* acc, const uchar* src, size_t n)
+{
+    size_t i = 0;
+    for (; i+16 <= n; i += 16)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+        __m256i* p = reinterpret_cast<__m256i*>(acc+i);
+        _mm256_storeu_si256(p,  _mm256_add_epi32(_mm256_loadu_si256(p),  _mm256_cvtepu8_epi32(s)));
+        _mm256_storeu_si256(p+1,_mm256_add_epi32(_mm256_loadu_si256(p+1),_mm256_cvtepu8_epi32(_mm_srli_si128(s,8))));
+    }
+    accumulate_scalar(acc+i,src+i,n-i);
+}
+
+__attribute__((target("avx2")))
+void lerp_avx2(uint16_t* out, const uchar* a, const uchar* b, size_t n, unsigned f)
+{
+    const __m256i wa = _mm256_set1_epi16(short(256-f)), wb = _mm256_set1_epi16(short(f));
+    size_t i = 0;
+    for (; i+16 <= n; i += 16)
+    {
+        __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i)));
+        __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b+i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out+i),
+            _mm256_add_epi16(_mm256_mullo_epi16(va,wa),_mm256_mullo_epi16(vb,wb)));
+    }
+    lerp_scalar(out+i,a+i,b+i,n-i,f);
+}
+
+#endif
+
+#if IMAGE_SCALER_NEON
+
+void accumulate_neon(uint32_t* acc, const uchar* src, size_t n)
+{
+    size_t i = 0;
+    for (; i+8 <= n; i += 8)
+    {
+        uint16x8_t s = vmovl_u8(vld1_u8(src+i));
+        vst1q_u32(acc+i,  vaddw_u16(vld1q_u32(acc+i),  vget_low_u16(s)));
+        vst1q_u32(acc+i+4,vaddw_u16(vld1q_u32(acc+i+4),vget_high_u16(s)));
+    }
+    accumulate_scalar(acc+i,src+i,n-i);
+}
+
+void lerp_neon(uint16_t* out, const uchar* a, const uchar* b, size_t n, unsigned f)
+{
+    // 256-f and f do not fit a byte when f is 0 or 256
+    uint16x8_t wa = vdupq_n_u16(uint16_t(256-f)), wb = vdupq_n_u16(uint16_t(f));
+    size_t i = 0;
+    for (; i+8 <= n; i += 8)
+        vst1q_u16(out+i,vmlaq_u16(vmulq_u16(vmovl_u8(vld1_u8(a+i)),wa),vmovl_u8(vld1_u8(b+i)),wb));
+    lerp_scalar(out+i,a+i,b+i,n-i,f);
+}
+
+#endif
+
+struct Row_kernels
+{
+    void (*accumulate)(uint32_t* acc, const uchar* src, size_t n);
+    void (*lerp)(uint16_t* out, const uchar* a, const uchar* b, size_t n, unsigned f);
+};
+
+// same choice as span_kernels()
+const Row_kernels& row_kernels()
+{
+    static const Row_kernels best = [] {
+#if IMAGE_SCALER_X86
+        if (kernel_supported(Kernel_type::avx2))
+            return Row_kernels{accumulate_avx2,lerp_avx2};
+        if (kernel_supported(Kernel_type::sse2))
+            return Row_kernels{accumulate_sse2,lerp_sse2};
+#endif
+#if IMAGE_SCALER_NEON
+        return Row_kernels{accumulate_neon,lerp_neon};
+#endif
+        return Row_kernels{accumulate_scalar,lerp_scalar};
+    }();
+    return best;
+}
+
+//
+// Filters
+//
+
+// every destination pixel averages the source pixels of the
+// box [x*w/dw,(x+1)*w/dw) x [y*h/dh,(y+1)*h/dh)
+void box(const uchar* src, int w, int h, int d, int ld, uchar* dst, int dw, int dh)
+{
+    const Row_kernels& k = row_kernels();
+    vector<uint32_t> acc(size_t(w)*d);
+    vector<int> x0(dw+1);
+    for (int x=0; x <= dw; x++)
+        x0[x] = int(int64_t(x)*w/dw);
+    for (int y=0; y < dh; y++)
+    {
+        int y0 = int(int64_t(y)*h/dh);
+        int y1 = max(int(int64_t(y+1)*h/dh),y0+1);
+        fill(acc.begin(),acc.end(),0);
+        for (int sy=y0; sy < y1; sy++)
+            k.accumulate(acc.data(),src+size_t(sy)*ld,acc.size());
+        uchar* out = dst+size_t(y)*dw*d;
+        for (int x=0; x < dw; x++)
+        {
+            int xa = x0[x], xb = max(x0[x+1],xa+1);
+            uint32_t n = uint32_t(xb-xa)*(y1-y0);
+            for (int c=0; c < d; c++)
+            {
+                uint32_t sum = 0;
+                for (int sx=xa; sx < xb; sx++)
+                    sum += acc[size_t(sx)*d+c];
+                *out++ = uchar((sum + n/2)/n);
+            }
+        }
+    }
+}
+
+// pixel centers are aligned: destination pixel x samples the
+// source at (x+0.5)*w/dw-0.5, clamped to the image
+void bilinear(const uchar* src, int w, int h, int d, int ld, uchar* dst, int dw, int dh)
+{
+    const Row_kernels& k = row_kernels();
+    vector<uint16_t> row(size_t(w)*d);
+    // horizontal taps in 8-bit fixed point
+    vector<int> tap(dw);
+    vector<unsigned> fx(dw);
+    for (int x=0; x < dw; x++)
+    {
+        int64_t sx = max<int64_t>(((2*int64_t(x)+1)*w*256)/(2*dw)-128,0);
+        tap[x] = min(int(sx >> 8),w-1);
+        fx[x] = (tap[x] < w-1) ? unsigned(sx & 255) : 0;
+    }
+    for (int y=0; y < dh; y++)
+    {
+        int64_t sy = max<int64_t>(((2*int64_t(y)+1)*h*256)/(2*dh)-128,0);
+        int y0 = min(int(sy >> 8),h-1);
+        int y1 = min(y0+1,h-1);
+        k.lerp(row.data(),src+size_t(y0)*ld,src+size_t(y1)*ld,row.size(),unsigned(sy & 255));
+        uchar* out = dst+size_t(y)*dw*d;
+        for (int x=0; x < dw; x++)
+        {
+            const uint16_t* a = &row[size_t(tap[x])*d];
+            const uint16_t* b = (tap[x] < w-1) ? a+d : a;
+            for (int c=0; c < d; c++)
+                *out++ = uchar((a[c]*(256-fx[x]) + b[c]*fx[x] + 32768) >> 16);
+        }
+    }
+}
+
+}
+
+// scales a w x h image with d channels (1 to 4) and ld bytes
+// per line (0 means w*d) into the dw x dh image dst, which has
+// the same channels and dw*d bytes per line
+void scale_pixels(const uchar* src, int w, int h, int d, int ld,
+                  uchar* dst, int dw, int dh, Scale_filter f)
+{
+    if ( (w <= 0) || (h <= 0) || (dw <= 0) || (dh <= 0) || (d < 1) || (d > 4) )
+        throw runtime_error("scale_pixels(): Invalid image size!");
+    if (ld == 0) ld = w*d;
+    if (f == Scale_filter::automatic)
+        f = ( (dw*2 <= w) && (dh*2 <= h) ) ? Scale_filter::box : Scale_filter::bilinear;
+    if (f == Scale_filter::box)
+        box(src,w,h,d,ld,dst,dw,dh);
+    else
+        bilinear(src,w,h,d,ld,dst,dw,dh);
+}
+
+// filtered copy of an image of size w x h, same as img->copy(w,h)
+// (nearest pixel) for the images whose pixels are not accessible
+Fl_Image* scale_image(Fl_Image* img, int w, int h, Scale_filter f)
+{
+    // only RGB images carry their pixels in data()[0]
+    if ( !img || (img->count() != 1) || (img->d() < 1) || (img->d() > 4) ||
+         (img->w() <= 0) || (img->h() <= 0) || (w <= 0) || (h <= 0) || !img->data() )
+        return img ? img->copy(w,h) : nullptr;
+    int d = img->d();
+    uchar* buf = new uchar[size_t(w)*h*d];
+    scale_pixels(reinterpret_cast<const uchar*>(img->data()[0]),img->w(),img->h(),
+                 d,img->ld(),buf,w,h,f);
+    Fl_RGB_Image* copy = new Fl_RGB_Image(buf,w,h,d);
+    // the image deletes the buffer
+    copy->alloc_array = 1;
+    return copy;
+}
+
+//
+// Mip pyramid
+//
+
+// constructor, the base image is not owned
+Mip_pyramid::Mip_pyramid(Fl_Image* base)
+{
+    if (!base) throw runtime_error("Mip_pyramid::Mip_pyramid(): No base image!");
+    mips.push_back(base);
+}
+
+// virtual destructor
+Mip_pyramid::~Mip_pyramid()
+{
+    for (size_t i=1; i < mips.size(); i++) delete mips[i];
+}
+
+// the smallest level which is still at least w x h
+Fl_Image* Mip_pyramid::level_for(int w, int h)
+{
+    Fl_Image* base = mips.front();
+    // only RGB images can be halved
+    if ( (base->count() != 1) || (base->d() < 1) || (base->d() > 4) || !base->data() )
+        return base;
+    for (size_t k=0;; k++)
+    {
+        Fl_Image* level = mips[k];
+        int lw = level->w()/2, lh = level->h()/2;
+        // the next level would be too small
+        if ( (lw < max(w,1)) || (lh < max(h,1)) )
+            return level;
+        if (k+1 == mips.size())
+            mips.push_back(scale_image(level,lw,lh,Scale_filter::box));
+    }
+}
+
+// filtered copy of size w x h made from level_for(w,h)
+Fl_Image* Mip_pyramid::scale(int w, int h, Scale_filter f)
+{
+    return scale_image(level_for(w,h),w,h,f);
+}
+
+} // namespace mathsophy::graphics
@@ -0,0 +1,101 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Image_scaler.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Image_scaler_hpp
+#define Image_scaler_hpp
+
+#include <cstddef>
+#include <vector>
+
+#include <FL/Fl_Image.H>
+
+namespace mathsophy::graphics
+{
+
+//
+// scaling filter enumerations
+//
+
+enum class Scale_filter
+{
+    automatic,  // box for reductions by 2 or more, bilinear otherwise
+    box,        // average of the source pixels covered by a pixel
+    bilinear    // weighted average of the 4 nearest source pixels
+};
+
+//
+// Image scaler
+//
+
+// scales a w x h image with d channels (1 to 4) and ld bytes
+// per line (0 means w*d) into the dw x dh image dst, which has
+// the same channels and dw*d bytes per line
+void scale_pixels(const uchar* src, int w, int h, int d, int ld,
+                  uchar* dst, int dw, int dh,
+                  Scale_filter f = Scale_filter::automatic);
+
+// filtered copy of an image of size w x h, same as img->copy(w,h)
+// (nearest pixel) for the images whose pixels are not accessible
+Fl_Image* scale_image(Fl_Image* img, int w, int h,
+                      Scale_filter f = Scale_filter::automatic);
+
+//
+// Mip pyramid
+//
+
+// the halvings of an image (level 0 is the image itself, level k
+// has size w/2^k x h/2^k), each computed at the first request
+// from the level above: a scaled copy filtered from the nearest
+// level costs about the size of the copy instead of the image
+class Mip_pyramid
+{
+public:
+    // constructor, the base image is not owned
+    Mip_pyramid(Fl_Image* base);
+    // no copy constructor allowed
+    Mip_pyramid(const Mip_pyramid&) = delete;
+    // no copy assignment allowed
+    Mip_pyramid& operator=(const Mip_pyramid&) = delete;
+    // virtual destructor
+    virtual ~Mip_pyramid();
+    // the smallest level which is still at least w x h, the
+    // base image if its pixels are not accessible
+    Fl_Image* level_for(int w, int h);
+    // filtered copy of size w x h made from level_for(w,h)
+    Fl_Image* scale(int w, int h, Scale_filter f = Scale_filter::automatic);
+    // number of levels computed so far, level 0 included
+    size_t levels() const { return mips.size(); }
+private:
+    std::vector<Fl_Image*> mips;   // mips[0] is the base image
+};
+
+}
+#endif /* Image_scaler_hpp */
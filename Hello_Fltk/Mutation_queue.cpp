@@ -0,0 +1,202 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Mutation_queue.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Mutation_queue.hpp"
+#include "Graphics.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+#include <FL/Fl.H>
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+// the queues alive: an Fl::awake() message cannot be
+// taken back, it may arrive after its queue is gone
+mutex live_mutex;
+unordered_set<const void*> live;
+
+bool is_live(const void* q)
+{
+    lock_guard<mutex> lock{live_mutex};
+    return live.count(q) != 0;
+}
+
+}
+
+// the FLTK lock is taken once by the main thread
+void init_fl_threads()
+{
+    static once_flag threads;
+    call_once(threads,[] { Fl::lock(); });
+}
+
+//
+// Mutation queue statistics
+//
+
+ostream& operator<<(ostream& os, const Mutation_queue_stats& s)
+{
+    return os << s.pushed << " pushed, " << s.dropped << " dropped, "
+              << s.applied << " applied in " << s.batches << " batches (mean "
+              << s.mean_batch() << ", max " << s.max_batch << "), max "
+              << s.max_pending << " pending, " << s.redraws << " redraws";
+}
+
+//
+// Mutation queue
+//
+
+// constructor, must be called by the UI thread
+Mutation_queue::Mutation_queue(size_t c, double fps) : capacity{max(c,size_t(1))}
+{
+    init_fl_threads();
+    frame = chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(fps > 0 ? 1/fps : 0));
+    lock_guard<mutex> lock{live_mutex};
+    live.insert(this);
+}
+
+// virtual destructor, the mutations still waiting are dropped
+Mutation_queue::~Mutation_queue()
+{
+    {
+        lock_guard<mutex> lock{live_mutex};
+        live.erase(this);
+    }
+    Fl::remove_timeout(timeout,this);
+    for (Node* n = head.exchange(nullptr); n; )
+    {
+        Node* next = n->next;
+        delete n;
+        n = next;
+    }
+}
+
+// queue f, to be called by the UI thread, which redraws the
+// window of w afterwards; false if the queue is full
+bool Mutation_queue::push(Widget& w, function<void()> f)
+{
+    // back-pressure: the slot is reserved first
+    size_t p = pending.fetch_add(1) + 1;
+    if (p > capacity)
+    {
+        pending--;
+        dropped++;
+        return false;
+    }
+    size_t m = max_pending.load();
+    while ( (p > m) && !max_pending.compare_exchange_weak(m,p) ) {}
+    // lock-free push on the front of the list
+    Node* n = new Node{&w,move(f),head.load(memory_order_relaxed)};
+    while ( !head.compare_exchange_weak(n->next,n,memory_order_release,memory_order_relaxed) ) {}
+    pushed++;
+    // one wake-up for all the mutations of a batch
+    if ( !scheduled.exchange(true) )
+        Fl::awake(awake,this);
+    return true;
+}
+
+// apply the waiting mutations now, UI thread only
+void Mutation_queue::drain()
+{
+    scheduled = false;
+    last = chrono::steady_clock::now();
+    Node* n = head.exchange(nullptr,memory_order_acquire);
+    if (!n) return;
+    // the list runs from the last pushed: reversed to apply in order
+    Node* first = nullptr;
+    while (n)
+    {
+        Node* next = n->next;
+        n->next = first;
+        first = n;
+        n = next;
+    }
+    size_t count = 0;
+    vector<Fl_Window*> windows;
+    for (n = first; n; )
+    {
+        n->f();
+        if (Fl_Window* win = n->w->window())
+            if (find(windows.begin(),windows.end(),win) == windows.end())
+                windows.push_back(win);
+        Node* next = n->next;
+        delete n;
+        n = next;
+        count++;
+    }
+    pending -= count;
+    applied += count;
+    batches++;
+    max_batch = max(max_batch,count);
+    // Fl_Widget::redraw(), Widget::redraw() would run the loop
+    for (auto win : windows) win->redraw();
+    redraws += windows.size();
+}
+
+// statistics since the construction, UI thread only
+Mutation_queue_stats Mutation_queue::get_stats() const
+{
+    Mutation_queue_stats s;
+    s.pushed = pushed;
+    s.dropped = dropped;
+    s.applied = applied;
+    s.pending = pending;
+    s.max_pending = max_pending;
+    s.batches = batches;
+    s.max_batch = max_batch;
+    s.redraws = redraws;
+    return s;
+}
+
+// Fl::awake() handler: drains now, or at the start of the next frame
+void Mutation_queue::awake(void* q)
+{
+    if ( !is_live(q) ) return;
+    Mutation_queue* mq = static_cast<Mutation_queue*>(q);
+    auto wait = mq->last + mq->frame - chrono::steady_clock::now();
+    if (wait > chrono::steady_clock::duration::zero())
+        Fl::add_timeout(chrono::duration<double>(wait).count(),timeout,q);
+    else mq->drain();
+}
+
+void Mutation_queue::timeout(void* q)
+{
+    static_cast<Mutation_queue*>(q)->drain();
+}
+
+} // namespace mathsophy::graphics
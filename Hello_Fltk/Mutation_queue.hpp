@@ -0,0 +1,121 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Mutation_queue.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Mutation_queue_hpp
+#define Mutation_queue_hpp
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+class Widget;
+
+// Fl::awake() with a handler needs the FLTK lock, which
+// is taken once by the main thread: call it from there
+// before other threads use Fl::awake()
+void init_fl_threads();
+
+//
+// Mutation queue statistics
+//
+
+struct Mutation_queue_stats
+{
+    size_t pushed{0};       // mutations accepted
+    size_t dropped{0};      // mutations refused, queue full
+    size_t applied{0};      // mutations applied by the UI thread
+    size_t pending{0};      // mutations waiting now
+    size_t max_pending{0};  // most mutations waiting at a time
+    size_t batches{0};      // drains which applied mutations
+    size_t max_batch{0};    // most mutations applied by one drain
+    size_t redraws{0};      // windows redrawn after a drain
+    double mean_batch() const { return batches ? double(applied)/batches : 0; }
+};
+
+ostream& operator<<(ostream& os, const Mutation_queue_stats& s);
+
+//
+// Mutation queue
+//
+
+// changes of shapes made by worker threads: any number of threads
+// push mutations without locks and without waiting, the UI thread
+// applies them in batches at most once per frame (woken up with
+// Fl::awake()) and redraws each window touched once per batch;
+// a full queue refuses new mutations instead of blocking
+class Mutation_queue
+{
+public:
+    // constructor, must be called by the UI thread; at most
+    // capacity mutations wait, batches are fps apart at least
+    Mutation_queue(size_t capacity = 65536, double fps = 60);
+    // no copy constructor allowed
+    Mutation_queue(const Mutation_queue&) = delete;
+    // no copy assignment allowed
+    Mutation_queue& operator=(const Mutation_queue&) = delete;
+    // virtual destructor, the mutations still waiting are dropped
+    virtual ~Mutation_queue();
+    // queue f, to be called by the UI thread, which redraws the
+    // window of w afterwards; false if the queue is full
+    bool push(Widget& w, function<void()> f);
+    // apply the waiting mutations now, UI thread only
+    void drain();
+    // statistics since the construction, UI thread only
+    Mutation_queue_stats get_stats() const;
+private:
+    struct Node
+    {
+        Widget* w;
+        function<void()> f;
+        Node* next;
+    };
+    atomic<Node*> head{nullptr};         // last pushed, list to the first
+    atomic<size_t> pending{0};           // mutations waiting
+    atomic<bool> scheduled{false};       // drain requested, not yet done
+    atomic<size_t> pushed{0}, dropped{0}, max_pending{0};
+    size_t capacity;
+    chrono::steady_clock::duration frame; // shortest time between batches
+    chrono::steady_clock::time_point last{};
+    size_t applied{0}, batches{0}, max_batch{0}, redraws{0};
+    // Fl::awake() and Fl::add_timeout() handlers
+    static void awake(void* q);
+    static void timeout(void* q);
+};
+
+}
+#endif /* Mutation_queue_hpp */
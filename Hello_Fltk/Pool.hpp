@@ -0,0 +1,107 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Pool.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Pool_hpp
+#define Pool_hpp
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// Pool
+//
+
+// objects of one type built in chunks of growing size, so that n
+// objects cost O(log n) allocations; the objects never move and
+// are all destroyed together with the pool
+template<class T> class Pool
+{
+public:
+    // constructor, size of the first chunk
+    Pool(size_t first = 4) : first_size{first ? first : 1}, next_size{first_size} {}
+    // no copy constructor allowed
+    Pool(const Pool&) = delete;
+    // no copy assignment allowed
+    Pool& operator=(const Pool&) = delete;
+    // virtual destructor
+    virtual ~Pool() { clear(); }
+    // build an object in the pool
+    template<class... Args> T* make(Args&&... args) {
+        if (chunks.empty() || (used == chunks.back().size))
+        {
+            chunks.push_back(Chunk{static_cast<T*>(::operator new(next_size*sizeof(T))),next_size});
+            next_size *= 2;
+            used = 0;
+        }
+        T* p = new (chunks.back().objects+used) T(std::forward<Args>(args)...);
+        used++;
+        nb_objects++;
+        return p;
+    }
+    // destroy all the objects, last built first
+    void clear() {
+        for (size_t c = chunks.size(); c-- > 0; )
+        {
+            size_t n = (c+1 == chunks.size()) ? used : chunks[c].size;
+            for (size_t i = n; i-- > 0; )
+                chunks[c].objects[i].~T();
+            ::operator delete(chunks[c].objects);
+        }
+        chunks.clear();
+        next_size = first_size;
+        used = 0;
+        nb_objects = 0;
+    }
+    // helper methods
+    size_t size() const { return nb_objects; }
+    size_t get_nb_chunks() const { return chunks.size(); }
+private:
+    struct Chunk
+    {
+        T* objects;   // raw storage of size objects
+        size_t size;
+    };
+    vector<Chunk> chunks;   // chunks in the order of allocation
+    size_t first_size;      // size of the first chunk
+    size_t next_size;       // size of the next chunk
+    size_t used{0};         // objects built in the last chunk
+    size_t nb_objects{0};   // objects in the pool
+};
+
+}
+#endif /* Pool_hpp */
@@ -0,0 +1,824 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Raster.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Raster.hpp"
+#include "Span_kernels.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace mathsophy::graphics
+{
+
+//
+// Built-in font
+//
+
+// 3x5 pixel glyphs for the characters ' ' to '_', one row
+// every 3 bits starting from the top, the leftmost pixel
+// is the most significant bit; lower case letters are
+// drawn in upper case
+static const uint16_t font_3x5[64] = {
+    0x0000, 0x2482, 0x5a00, 0x5f7d, 0x3c9e, 0x52a5, 0x2aab, 0x2400,
+    0x1491, 0x4494, 0x0aa8, 0x05d0, 0x0014, 0x01c0, 0x0002, 0x12a4,
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7252,
+    0x7bef, 0x7bcf, 0x0410, 0x0414, 0x1511, 0x0e38, 0x4454, 0x72c2,
+    0x7be7, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b,
+    0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a,
+    0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a, 0x5bfd,
+    0x5aad, 0x5a92, 0x72a7, 0x3493, 0x4889, 0x6496, 0x2a00, 0x0007
+};
+
+// glyph of a character
+static uint16_t glyph(char c)
+{
+    switch (c) {
+        case '`': return 0x4400;
+        case '{': return 0x3593;
+        case '|': return 0x2492;
+        case '}': return 0x64d6;
+        case '~': return 0x0780;
+    }
+    if ( (c >= 'a') && (c <= 'z') )
+        c = c - 'a' + 'A';
+    if ( (c < ' ') || (c > '_') )
+        c = '?';
+    return font_3x5[c-' '];
+}
+
+//
+// Conversion function Fl_Color -> Pixel
+//
+
+Pixel to_pixel(Fl_Color c)
+{
+    uchar r{0},g{0},b{0};
+    Fl::get_color(c,r,g,b);
+    return pack_pixel(r,g,b);
+}
+
+//
+// Canvas
+//
+
+// change the size, the memory is reused if large enough
+void Canvas::resize(int w, int h)
+{
+    if ( (w < 0) || (h < 0) )
+        throw runtime_error("Canvas::resize(): negative size!");
+    width = w;
+    height = h;
+    px.resize(size_t(w)*h);
+}
+
+// fill the whole canvas with one color
+void Canvas::clear(Fl_Color c)
+{
+    fill(to_pixel(c));
+}
+
+void Canvas::fill(Pixel p)
+{
+    std::fill(px.begin(),px.end(),p);
+}
+
+// write to a file, the format is chosen by the extension
+void Canvas::write(const string& fn) const
+{
+    auto ends_with = [&fn](const string& ext) {
+        return (fn.size() >= ext.size()) &&
+               (fn.compare(fn.size()-ext.size(),ext.size(),ext) == 0);
+    };
+    if (ends_with(".png"))
+        write_png(fn);
+    else if (ends_with(".ppm"))
+        write_ppm(fn);
+    else throw runtime_error("Canvas::write(): Unknown format for file " + fn + "!");
+}
+
+// binary portable pixmap, written one row at a time
+void Canvas::write_ppm(const string& fn) const
+{
+    ofstream os{fn,ios::binary};
+    if (!os)
+        throw runtime_error("Canvas::write_ppm(): File " + fn + " cannot be opened!");
+    os << "P6\n" << width << ' ' << height << "\n255\n";
+    vector<char> line(size_t(width)*3);
+    for (int y=0; y < height; y++)
+    {
+        const Pixel* p = row(y);
+        for (int x=0; x < width; x++)
+        {
+            line[3*x]   = char(red(p[x]));
+            line[3*x+1] = char(green(p[x]));
+            line[3*x+2] = char(blue(p[x]));
+        }
+        os.write(line.data(),line.size());
+    }
+    if (!os)
+        throw runtime_error("Canvas::write_ppm(): File " + fn + " write error!");
+}
+
+namespace
+{
+
+// CRC-32 as required by the PNG chunks
+uint32_t crc32(uint32_t crc, const uchar* p, size_t n)
+{
+    static const vector<uint32_t> table = [] {
+        vector<uint32_t> t(256);
+        for (uint32_t i=0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k=0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : (c >> 1);
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    while (n--) crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// PNG encoder using stored (uncompressed) deflate blocks: it needs
+// no zlib and only keeps one block of 64 KiB in memory
+class Png_writer
+{
+public:
+    Png_writer(ofstream& s) : os{s} {}
+    // write the signature and the header chunk
+    void header(int w, int h)
+    {
+        static const uchar signature[8] = {137,'P','N','G','\r','\n',26,'\n'};
+        os.write(reinterpret_cast<const char*>(signature),8);
+        vector<uchar> ihdr;
+        put32(ihdr,w); put32(ihdr,h);
+        // 8 bits per channel, RGB, deflate, no filter, no interlace
+        ihdr.insert(ihdr.end(),{8,2,0,0,0});
+        chunk("IHDR",ihdr);
+    }
+    // append raw image data
+    void put(const uchar* p, size_t n)
+    {
+        update_adler(p,n);
+        while (n > 0)
+        {
+            size_t k = min(n,max_block-block.size());
+            block.insert(block.end(),p,p+k);
+            p += k; n -= k;
+            if (block.size() == max_block)
+                flush(false);
+        }
+    }
+    // write the last block and the end chunk
+    void finish()
+    {
+        flush(true);
+        chunk("IEND",{});
+    }
+private:
+    static const size_t max_block = 65535;
+    ofstream& os;
+    vector<uchar> block;
+    bool first{true};
+    uint32_t adler_a{1};
+    uint32_t adler_b{0};
+    static void put32(vector<uchar>& v, uint32_t x)
+    {
+        v.insert(v.end(),{uchar(x>>24),uchar(x>>16),uchar(x>>8),uchar(x)});
+    }
+    void update_adler(const uchar* p, size_t n)
+    {
+        // 5552 is the largest run without overflow before the modulo
+        while (n > 0)
+        {
+            size_t k = min(n,size_t(5552));
+            n -= k;
+            while (k--) { adler_a += *p++; adler_b += adler_a; }
+            adler_a %= 65521; adler_b %= 65521;
+        }
+    }
+    void chunk(const char* type, const vector<uchar>& data)
+    {
+        vector<uchar> buf;
+        put32(buf,uint32_t(data.size()));
+        buf.insert(buf.end(),type,type+4);
+        buf.insert(buf.end(),data.begin(),data.end());
+        put32(buf,crc32(0,buf.data()+4,buf.size()-4));
+        os.write(reinterpret_cast<const char*>(buf.data()),buf.size());
+    }
+    // every stored block goes into its own IDAT chunk
+    void flush(bool final)
+    {
+        vector<uchar> data;
+        if (first)
+        {
+            // zlib header: deflate, 32K window, no dictionary
+            data.insert(data.end(),{0x78,0x01});
+            first = false;
+        }
+        uint16_t len = uint16_t(block.size());
+        data.insert(data.end(),{uchar(final ? 1 : 0),
+                                uchar(len),uchar(len>>8),
+                                uchar(~len),uchar(uint16_t(~len)>>8)});
+        data.insert(data.end(),block.begin(),block.end());
+        if (final) put32(data,(adler_b << 16) | adler_a);
+        chunk("IDAT",data);
+        block.clear();
+    }
+};
+
+}
+
+// portable network graphics, written one row at a time
+void Canvas::write_png(const string& fn) const
+{
+    ofstream os{fn,ios::binary};
+    if (!os)
+        throw runtime_error("Canvas::write_png(): File " + fn + " cannot be opened!");
+    Png_writer png{os};
+    png.header(width,height);
+    // every row starts with the filter type 0 (none)
+    vector<uchar> line(size_t(width)*3+1);
+    for (int y=0; y < height; y++)
+    {
+        const Pixel* p = row(y);
+        for (int x=0; x < width; x++)
+        {
+            line[3*x+1] = red(p[x]);
+            line[3*x+2] = green(p[x]);
+            line[3*x+3] = blue(p[x]);
+        }
+        png.put(line.data(),line.size());
+    }
+    png.finish();
+    if (!os)
+        throw runtime_error("Canvas::write_png(): File " + fn + " write error!");
+}
+
+//
+// Raster
+//
+
+// constructor
+Raster::Raster(Canvas& c) : Raster{c,span_kernels()}
+{
+}
+
+Raster::Raster(Canvas& c, const Span_kernels& k) : canvas{c}, kernels{k}
+{
+    clips.push_back(Clip{0,0,c.w(),c.h()});
+    color(FL_BLACK);
+}
+
+// setter methods for color, line style, font
+void Raster::color(Fl_Color c)
+{
+    fl_col = c;
+    pix = to_pixel(c);
+}
+
+void Raster::line_style(int style, int width)
+{
+    line_width = (width > 0) ? width : 1;
+    // same dash pattern as the X11 version of fl_line_style
+    int dash = 3*line_width;
+    int dot  = line_width;
+    int gap  = line_width;
+    switch (style & 0xff) {
+        case FL_DASH:
+            nb_dashes = 2;
+            dashes[0] = dash; dashes[1] = gap;
+            break;
+        case FL_DOT:
+            nb_dashes = 2;
+            dashes[0] = dot; dashes[1] = gap;
+            break;
+        case FL_DASHDOT:
+            nb_dashes = 4;
+            dashes[0] = dash; dashes[1] = gap;
+            dashes[2] = dot;  dashes[3] = gap;
+            break;
+        case FL_DASHDOTDOT:
+            nb_dashes = 6;
+            dashes[0] = dash; dashes[1] = gap;
+            dashes[2] = dot;  dashes[3] = gap;
+            dashes[4] = dot;  dashes[5] = gap;
+            break;
+        default:
+            nb_dashes = 0;
+    }
+}
+
+void Raster::font(Fl_Font /*f*/, Fl_Fontsize s)
+{
+    // only the size matters for the built-in font
+    font_size = (s > 0) ? s : FL_NORMAL_SIZE;
+}
+
+// clipping
+void Raster::push_clip(int x, int y, int w, int h)
+{
+    Clip c = clip();
+    clips.push_back(Clip{max(c.x0,x),max(c.y0,y),
+                         min(c.x1,x+w),min(c.y1,y+h)});
+}
+
+// the part X,Y,W,H of the box x,y,w,h inside the clip area,
+// same semantics as fl_clip_box: non zero if the box was cut
+int Raster::clip_box(int x, int y, int w, int h, int& X, int& Y, int& W, int& H) const
+{
+    const Clip& c = clip();
+    X = max(x,c.x0);
+    Y = max(y,c.y0);
+    W = max(0,min(x+w,c.x1)-X);
+    H = max(0,min(y+h,c.y1)-Y);
+    return (X != x) || (Y != y) || (W != w) || (H != h);
+}
+
+void Raster::pop_clip()
+{
+    // the whole canvas is never popped
+    if (clips.size() > 1)
+        clips.pop_back();
+}
+
+// translucent drawing: the primitives of a layer are drawn as
+// usual into transparent pixels, so that overlapping parts of
+// one shape (thick strokes, outlines over fills) are composited
+// with the canvas only once
+void Raster::begin_layer()
+{
+    if (target != &canvas)
+        throw runtime_error("Raster::begin_layer(): Layers cannot be nested!");
+    const Clip& c = clip();
+    layer.resize(max(c.x1-c.x0,0),max(c.y1-c.y0,0));
+    if ( (layer.w() > 0) && (layer.h() > 0) )
+        kernels.fill(layer.row(0),size_t(layer.w())*layer.h(),0);
+    target = &layer;
+    ox = c.x0;
+    oy = c.y0;
+}
+
+void Raster::end_layer(uchar a)
+{
+    if (target != &layer)
+        throw runtime_error("Raster::end_layer(): No layer to end!");
+    target = &canvas;
+    for (int y=0; y < layer.h(); y++)
+        kernels.over(canvas.row(oy+y)+ox,layer.row(y),size_t(layer.w()),a);
+    ox = oy = 0;
+}
+
+// drawing primitives
+void Raster::point(int x, int y)
+{
+    plot(x,y);
+}
+
+void Raster::line(int x0, int y0, int x1, int y1)
+{
+    reset_dashes();
+    // axis-aligned lines are drawn as filled rectangles
+    if ( (x0 == x1) || (y0 == y1) )
+    {
+        axis_line(x0,y0,x1,y1);
+        return;
+    }
+    if ( aa && (line_width == 1) && (nb_dashes == 0) )
+    {
+        wu_line(x0,y0,x1,y1);
+        return;
+    }
+    // Bresenham's algorithm for all the other lines
+    int dx = abs(x1-x0), sx = (x0 < x1) ? 1 : -1;
+    int dy = -abs(y1-y0), sy = (y0 < y1) ? 1 : -1;
+    int err = dx+dy;
+    for (;;)
+    {
+        if (next_dash()) brush(x0,y0);
+        if ( (x0 == x1) && (y0 == y1) )
+            break;
+        int e2 = 2*err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void Raster::rect(int x, int y, int w, int h)
+{
+    if ( (w <= 0) || (h <= 0) )
+        return;
+    xyline(x,y,x+w-1);
+    xyline(x,y+h-1,x+w-1);
+    yxline(x,y,y+h-1);
+    yxline(x+w-1,y,y+h-1);
+}
+
+void Raster::rectf(int x, int y, int w, int h)
+{
+    const Clip& c = clip();
+    int x0 = max(x,c.x0), x1 = min(x+w,c.x1);
+    int y0 = max(y,c.y0), y1 = min(y+h,c.y1);
+    if ( (x0 >= x1) || (y0 >= y1) )
+        return;
+    // narrow rectangles (vertical lines) are filled column
+    // by column, everything else row by row
+    if (x1-x0 <= 4)
+    {
+        for (int xx=x0; xx < x1; xx++)
+            kernels.column(at(xx,y0),size_t(y1-y0),target->w(),pix);
+        return;
+    }
+    for (int yy=y0; yy < y1; yy++)
+        kernels.fill(at(x0,yy),size_t(x1-x0),pix);
+}
+
+// fill of a shape given as spans sorted by rising y and moved
+// by dx,dy; the spans outside of the clip rows are skipped
+// without a look
+void Raster::spans(const Span* s, size_t n, int dx, int dy)
+{
+    const Clip& c = clip();
+    const Span* e = s+n;
+    s = lower_bound(s,e,c.y0-dy,[](const Span& a, int y) { return a.y < y; });
+    for (; (s != e) && (s->y+dy < c.y1); s++)
+    {
+        int x0 = max(s->x0+dx,c.x0), x1 = min(s->x1+dx,c.x1);
+        if (x0 < x1)
+            kernels.fill(at(x0,s->y+dy),size_t(x1-x0),pix);
+    }
+}
+
+// points of the ellipse inscribed in the box 0,0,w,h passed to
+// plot(x,y) (midpoint algorithm), shared by arc() and the spans
+// of ellipse_spans()
+template<class F>
+static void ellipse_points(int w, int h, F plot)
+{
+    long a = (w-1)/2, b = (h-1)/2;
+    // even sizes have a center between two pixels: the right
+    // and bottom halves are shifted by one
+    int ex = (w-1) & 1, ey = (h-1) & 1;
+    int cx = int(a), cy = int(b);
+    auto plot4 = [&](long dx, long dy) {
+        plot(cx+int(dx)+ex,cy+int(dy)+ey);
+        plot(cx-int(dx),   cy+int(dy)+ey);
+        plot(cx+int(dx)+ex,cy-int(dy));
+        plot(cx-int(dx),   cy-int(dy));
+    };
+    double a2 = double(a*a), b2 = double(b*b);
+    long dx = 0, dy = b;
+    // region 1: slope above -1
+    double d1 = b2 - a2*b + 0.25*a2;
+    while (b2*dx < a2*dy)
+    {
+        plot4(dx,dy);
+        if (d1 < 0)
+            d1 += b2*(2*dx+3);
+        else
+        {
+            d1 += b2*(2*dx+3) + a2*(2-2*dy);
+            dy--;
+        }
+        dx++;
+    }
+    // region 2: slope below -1
+    double d2 = b2*(dx+0.5)*(dx+0.5) + a2*(dy-1)*(dy-1) - a2*b2;
+    while (dy >= 0)
+    {
+        plot4(dx,dy);
+        if (d2 > 0)
+            d2 += a2*(3-2*dy);
+        else
+        {
+            d2 += b2*(2*dx+2) + a2*(3-2*dy);
+            dx++;
+        }
+        dy--;
+    }
+}
+
+// outline of the ellipse inscribed in the box x,y,w,h
+// (midpoint algorithm, dashes are not applied)
+void Raster::arc(int x, int y, int w, int h)
+{
+    if ( (w <= 0) || (h <= 0) )
+        return;
+    ellipse_points(w,h,[&](int px, int py) { brush(x+px,y+py); });
+}
+
+// the pixels which arc(0,0,w,h) sets with lines of the given
+// width as spans, the inside of the ellipse too if filled: a
+// shape drawing many equal ellipses computes them only once
+vector<Span> Raster::ellipse_spans(int w, int h, int width, bool filled)
+{
+    vector<Span> s;
+    if ( (w <= 0) || (h <= 0) )
+        return s;
+    // the pixels set by brush(), as runs [x0,x1) of each row
+    width = max(width,1);
+    int o = width/2;
+    vector< vector< pair<int,int> > > runs(size_t(h+width));
+    ellipse_points(w,h,[&](int px, int py) {
+        for (int y=py-o; y < py-o+width; y++)
+            runs[size_t(y+o)].push_back({px-o,px-o+width});
+    });
+    // join the overlapping and touching runs of each row
+    for (size_t r=0; r < runs.size(); r++)
+    {
+        vector< pair<int,int> >& v = runs[r];
+        if (v.empty())
+            continue;
+        sort(v.begin(),v.end());
+        int y = int(r)-o;
+        if (filled)
+        {
+            int x1 = v[0].second;
+            for (auto& run : v)
+                x1 = max(x1,run.second);
+            s.push_back({y,v[0].first,x1});
+            continue;
+        }
+        Span cur{y,v[0].first,v[0].second};
+        for (auto& run : v)
+        {
+            if (run.first > cur.x1)
+            {
+                s.push_back(cur);
+                cur.x0 = run.first;
+            }
+            cur.x1 = max(cur.x1,run.second);
+        }
+        s.push_back(cur);
+    }
+    return s;
+}
+
+// draw a string with the built-in font, y is the baseline
+void Raster::draw(const string& s, int x, int y)
+{
+    int k = glyph_scale(font_size);
+    int top = y-5*k;
+    for (char c : s)
+    {
+        uint16_t g = glyph(c);
+        for (int row=0; row < 5; row++)
+            for (int col=0; col < 3; col++)
+                if (g & (1 << (14-3*row-col)))
+                    rectf(x+col*k,top+row*k,k,k);
+        x += 4*k;
+    }
+}
+
+// copy w x h pixels from a buffer of depth d (1 to 4)
+// and line length ld (0 means w*d), d=2 and d=4 have alpha
+void Raster::draw_image(const uchar* buf, int d, int ld, int x, int y, int w, int h)
+{
+    if (ld == 0) ld = w*d;
+    const Clip& c = clip();
+    int x0 = max(x,c.x0), x1 = min(x+w,c.x1);
+    int y0 = max(y,c.y0), y1 = min(y+h,c.y1);
+    if (x0 >= x1)
+        return;
+    // pixels without alpha are copied, the others are
+    // premultiplied and composited a row at a time
+    bool opaque = (d == 1) || (d == 3);
+    vector<Pixel> row(opaque ? 0 : size_t(x1-x0));
+    for (int yy=y0; yy < y1; yy++)
+    {
+        const uchar* src = buf + size_t(yy-y)*ld + size_t(x0-x)*d;
+        Pixel* dst = at(x0,yy);
+        for (int i=0; i < x1-x0; i++, src += d)
+        {
+            uchar r = src[0];
+            uchar g = (d >= 3) ? src[1] : src[0];
+            uchar b = (d >= 3) ? src[2] : src[0];
+            if (opaque)
+            {
+                dst[i] = pack_pixel(r,g,b);
+                continue;
+            }
+            unsigned a = (d == 2) ? src[1] : (d == 4) ? src[3] : 255;
+            row[i] = premultiply(pack_pixel(r,g,b),a);
+        }
+        if (!opaque)
+            kernels.over(dst,row.data(),row.size(),255);
+    }
+}
+
+// size of a string drawn with the built-in font
+int Raster::text_width(const string& s, Fl_Fontsize size)
+{
+    return int(s.size())*4*glyph_scale(size);
+}
+
+int Raster::text_height(Fl_Fontsize size)
+{
+    return 5*glyph_scale(size);
+}
+
+// helper methods
+void Raster::plot(int x, int y)
+{
+    const Clip& c = clip();
+    if ( (x < c.x0) || (x >= c.x1) || (y < c.y0) || (y >= c.y1) )
+        return;
+    *at(x,y) = pix;
+}
+
+void Raster::brush(int x, int y)
+{
+    if (line_width == 1)
+        plot(x,y);
+    else
+        rectf(x-line_width/2,y-line_width/2,line_width,line_width);
+}
+
+void Raster::reset_dashes()
+{
+    dash_index = 0;
+    dash_left = (nb_dashes > 0) ? dashes[0] : 0;
+}
+
+bool Raster::next_dash()
+{
+    if (nb_dashes == 0)
+        return true;
+    // even entries of the pattern are drawn, odd ones are gaps
+    bool on = (dash_index % 2 == 0);
+    if (--dash_left == 0)
+    {
+        dash_index = (dash_index+1) % nb_dashes;
+        dash_left = dashes[dash_index];
+    }
+    return on;
+}
+
+// horizontal or vertical line, every run of the
+// dash pattern is filled as a single rectangle
+void Raster::axis_line(int x0, int y0, int x1, int y1)
+{
+    bool horizontal = (y0 == y1);
+    int sx = (x1 > x0) - (x1 < x0);
+    int sy = (y1 > y0) - (y1 < y0);
+    int n = max(abs(x1-x0),abs(y1-y0))+1;
+    int half = line_width/2;
+    auto fill_run = [&](int i, int j) {
+        int xa = x0+i*sx, xb = x0+j*sx;
+        int ya = y0+i*sy, yb = y0+j*sy;
+        if (horizontal)
+            rectf(min(xa,xb),y0-half,abs(xb-xa)+1,line_width);
+        else
+            rectf(x0-half,min(ya,yb),line_width,abs(yb-ya)+1);
+    };
+    int start = -1;
+    for (int i=0; i <= n; i++)
+    {
+        bool on = (i < n) && next_dash();
+        if (on && (start < 0))
+            start = i;
+        else if (!on && (start >= 0))
+        {
+            fill_run(start,i-1);
+            start = -1;
+        }
+    }
+}
+
+// Wu's algorithm: at every step along the major axis the
+// line covers two pixels across it, their coverages are the
+// distances of the exact line from the two pixel centers
+void Raster::wu_line(int x0, int y0, int x1, int y1)
+{
+    const Clip& c = clip();
+    bool steep = abs(y1-y0) > abs(x1-x0);
+    // long flat lines: the pixels of a row are collected
+    // in runs and blended as spans
+    if ( !steep && (abs(x1-x0) >= 64) )
+    {
+        wu_runs(x0,y0,x1,y1);
+        return;
+    }
+    // the major axis becomes u, the minor one v
+    if (steep) { swap(x0,y0); swap(x1,y1); }
+    if (x0 > x1) { swap(x0,x1); swap(y0,y1); }
+    int64_t step = (int64_t(y1-y0) << 16)/(x1-x0);
+    int64_t fv = int64_t(y0) << 16;
+    ptrdiff_t dv = steep ? 1 : target->w();
+    // no clipping needed if the pixel pairs are all inside
+    int u_min = steep ? c.y0 : c.x0, u_max = steep ? c.y1 : c.x1;
+    int v_min = steep ? c.x0 : c.y0, v_max = steep ? c.x1 : c.y1;
+    bool inside = (x0 >= u_min) && (x1 < u_max) &&
+                  (min(y0,y1) >= v_min) && (max(y0,y1)+1 < v_max);
+    for (int u=x0; u <= x1; u++, fv += step)
+    {
+        int v = int(fv >> 16);
+        unsigned f = unsigned(fv >> 8) & 255;
+        if (inside)
+        {
+            Pixel* p = steep ? at(v,u) : at(u,v);
+            p[0] = blend_pixel(p[0],pix,255-f);
+            p[dv] = blend_pixel(p[dv],pix,f);
+            continue;
+        }
+        if ( (u < u_min) || (u >= u_max) )
+            continue;
+        if ( (v >= v_min) && (v < v_max) )
+        {
+            Pixel* p = steep ? at(v,u) : at(u,v);
+            *p = blend_pixel(*p,pix,255-f);
+        }
+        if ( (v+1 >= v_min) && (v+1 < v_max) )
+        {
+            Pixel* p = steep ? at(v+1,u) : at(u,v+1);
+            *p = blend_pixel(*p,pix,f);
+        }
+    }
+}
+
+// flat lines, one run per row
+void Raster::wu_runs(int x0, int y0, int x1, int y1)
+{
+    if (x0 > x1) { swap(x0,x1); swap(y0,y1); }
+    const int max_run = 256;
+    uchar upper[max_run], lower[max_run];
+    int64_t step = (int64_t(y1-y0) << 16)/(x1-x0);
+    int64_t fy = int64_t(y0) << 16;
+    int run_x = x0, run_y = y0, n = 0;
+    for (int x=x0; x <= x1; x++, fy += step)
+    {
+        int y = int(fy >> 16);
+        if ( (y != run_y) || (n == max_run) )
+        {
+            blend_run(run_y,run_x,upper,n);
+            blend_run(run_y+1,run_x,lower,n);
+            run_x = x; run_y = y; n = 0;
+        }
+        unsigned f = unsigned(fy >> 8) & 255;
+        upper[n] = uchar(255-f);
+        lower[n] = uchar(f);
+        n++;
+    }
+    blend_run(run_y,run_x,upper,n);
+    blend_run(run_y+1,run_x,lower,n);
+}
+
+// blend n pixels of row y from x with the current color
+void Raster::blend_run(int y, int x, const uchar* cov, int n)
+{
+    const Clip& c = clip();
+    if ( (y < c.y0) || (y >= c.y1) )
+        return;
+    int x0 = max(x,c.x0), x1 = min(x+n,c.x1);
+    if (x0 >= x1)
+        return;
+    Pixel* p = at(x0,y);
+    cov += x0-x;
+    // short runs (steep slopes) are not worth the call
+    if (x1-x0 >= 8)
+        kernels.blend(p,cov,size_t(x1-x0),pix);
+    else
+        for (int i=0; i < x1-x0; i++)
+            p[i] = blend_pixel(p[i],pix,cov[i]);
+}
+
+// glyph pixels are squares of this size, the capital
+// height is then about 70% of the font size
+int Raster::glyph_scale(Fl_Fontsize size)
+{
+    if (size <= 0) size = FL_NORMAL_SIZE;
+    return max(1,(10*size+35)/70);
+}
+
+} // namespace mathsophy::graphics
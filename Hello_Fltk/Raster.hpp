@@ -0,0 +1,250 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Raster.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Raster_hpp
+#define Raster_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <FL/Fl.H>
+#include <FL/Enumerations.H>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+struct Span_kernels;
+
+//
+// Pixel
+//
+
+// a pixel is stored as 4 bytes R,G,B,A packed
+// into a 32-bit word, red in the lowest byte
+typedef uint32_t Pixel;
+
+inline Pixel pack_pixel(uchar r, uchar g, uchar b, uchar a = 255)
+{
+    return Pixel(r) | (Pixel(g) << 8) | (Pixel(b) << 16) | (Pixel(a) << 24);
+}
+
+inline uchar red(Pixel p)   { return uchar(p);       }
+inline uchar green(Pixel p) { return uchar(p >> 8);  }
+inline uchar blue(Pixel p)  { return uchar(p >> 16); }
+inline uchar alpha(Pixel p) { return uchar(p >> 24); }
+
+// s drawn over d with coverage a (0 to 255), the
+// four channels are rounded to the nearest value
+inline Pixel blend_pixel(Pixel d, Pixel s, unsigned a)
+{
+    // two channels at a time, 16 bits each
+    unsigned b = 255-a;
+    Pixel rb = (s & 0x00ff00ff)*a + (d & 0x00ff00ff)*b + 0x00800080;
+    Pixel ga = ((s >> 8) & 0x00ff00ff)*a + ((d >> 8) & 0x00ff00ff)*b + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    ga = (ga + ((ga >> 8) & 0x00ff00ff)) & 0xff00ff00;
+    return rb | ga;
+}
+
+// p with all its channels scaled by a: the premultiplied
+// form of p drawn with opacity a
+inline Pixel premultiply(Pixel p, unsigned a)
+{
+    return blend_pixel(0,p,a);
+}
+
+// premultiplied s drawn over d
+inline Pixel over_pixel(Pixel d, Pixel s)
+{
+    unsigned b = 255-alpha(s);
+    Pixel rb = (d & 0x00ff00ff)*b + 0x00800080;
+    Pixel ga = ((d >> 8) & 0x00ff00ff)*b + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    ga = (ga + ((ga >> 8) & 0x00ff00ff)) & 0xff00ff00;
+    return s + (rb | ga);
+}
+
+// conversion function Fl_Color -> Pixel
+Pixel to_pixel(Fl_Color c);
+
+//
+// Span
+//
+
+// pixels [x0,x1) of the row y, the output of a
+// scanline fill; fills list their spans by rising y
+struct Span
+{
+    int y;
+    int x0;
+    int x1;
+};
+
+//
+// Canvas
+//
+
+// a block of pixels in memory which the software
+// render path draws into, it needs no window and
+// no display connection
+class Canvas
+{
+public:
+    // constructor
+    Canvas(int w, int h) { resize(w,h); }
+    // no copy constructor allowed
+    Canvas(const Canvas&) = delete;
+    // no copy assignment allowed
+    Canvas& operator=(const Canvas&) = delete;
+    // virtual destructor
+    virtual ~Canvas() {}
+    // change the size, the memory is reused if large enough
+    void resize(int w, int h);
+    // fill the whole canvas with one color
+    void clear(Fl_Color c);
+    void fill(Pixel p);
+    // getter methods
+    int w() const { return width;  }
+    int h() const { return height; }
+    Pixel* row(int y)             { return &px[size_t(y)*width]; }
+    const Pixel* row(int y) const { return &px[size_t(y)*width]; }
+    // write to a file, the format is chosen
+    // by the extension (.png or .ppm)
+    void write(const string& fn) const;
+    void write_ppm(const string& fn) const;
+    void write_png(const string& fn) const;
+private:
+    vector<Pixel> px;   // pixels, row after row
+    int width{0};       // width in pixels
+    int height{0};      // height in pixels
+};
+
+//
+// Raster
+//
+
+// drawing context on a canvas, it mirrors the fl_* drawing
+// functions of FLTK so that every Shape can render itself
+// without FLTK: the state (color, line style, font, clip)
+// belongs to the raster, the pixels to the canvas
+class Raster
+{
+public:
+    // constructor, the span kernels default
+    // to the fastest ones for this CPU
+    Raster(Canvas& c);
+    Raster(Canvas& c, const Span_kernels& k);
+    // no copy constructor allowed
+    Raster(const Raster&) = delete;
+    // no copy assignment allowed
+    Raster& operator=(const Raster&) = delete;
+    // virtual destructor
+    virtual ~Raster() {}
+    // setter and getter methods for
+    // color, line style, font
+    void color(Fl_Color c);
+    Fl_Color color() const { return fl_col; }
+    void line_style(int style, int width = 0);
+    void font(Fl_Font f, Fl_Fontsize s);
+    Fl_Fontsize size() const { return font_size; }
+    // anti-aliased mode: solid lines of width 1 which are
+    // not axis-aligned are drawn with Wu's algorithm
+    void antialias(bool on) { aa = on; }
+    bool antialias() const { return aa; }
+    // clipping, same semantics as fl_push_clip, fl_pop_clip
+    // and fl_clip_box
+    void push_clip(int x, int y, int w, int h);
+    void pop_clip();
+    int clip_box(int x, int y, int w, int h, int& X, int& Y, int& W, int& H) const;
+    // translucent drawing: what is drawn between begin_layer()
+    // and end_layer() goes to a transparent layer covering the
+    // current clip area, end_layer() composites it over the
+    // canvas with opacity a (0 to 255); layers cannot be nested
+    void begin_layer();
+    void end_layer(uchar a);
+    // drawing primitives
+    void point(int x, int y);
+    void line(int x0, int y0, int x1, int y1);
+    void xyline(int x0, int y, int x1) { line(x0,y,x1,y); }
+    void yxline(int x, int y0, int y1) { line(x,y0,x,y1); }
+    void rect(int x, int y, int w, int h);
+    void rectf(int x, int y, int w, int h);
+    void spans(const Span* s, size_t n, int dx = 0, int dy = 0);
+    void arc(int x, int y, int w, int h);
+    void draw(const string& s, int x, int y);
+    void draw_image(const uchar* buf, int d, int ld, int x, int y, int w, int h);
+    // pixels set by arc(0,0,w,h) with lines of the given
+    // width as spans, with the inside too if filled
+    static vector<Span> ellipse_spans(int w, int h, int width, bool filled);
+    // size of a string drawn with the built-in font
+    int text_width(const string& s) const { return text_width(s,font_size); }
+    int text_height() const { return text_height(font_size); }
+    // same at a given font size, 0 is the default size
+    static int text_width(const string& s, Fl_Fontsize size);
+    static int text_height(Fl_Fontsize size);
+    // helper methods
+    Canvas& get_canvas() { return canvas; }
+private:
+    struct Clip { int x0, y0, x1, y1; }; // [x0,x1) x [y0,y1)
+    Canvas& canvas;                      // target pixels
+    Canvas layer{0,0};                   // premultiplied pixels of a layer
+    Canvas* target{&canvas};             // canvas or layer
+    int ox{0}, oy{0};                    // canvas position of the target
+    const Span_kernels& kernels;         // innermost fill loops
+    vector<Clip> clips;                  // clip stack, back() is the current one
+    Fl_Color fl_col{FL_BLACK};           // current FLTK color
+    Pixel pix{0};                        // current color as a pixel
+    int line_width{1};                   // line width in pixels
+    int dashes[6]{};                     // on/off lengths of the dash pattern
+    int nb_dashes{0};                    // 0 means solid
+    int dash_index{0};                   // current entry of the pattern
+    int dash_left{0};                    // pixels left in the current entry
+    Fl_Fontsize font_size{FL_NORMAL_SIZE}; // font size
+    bool aa{false};                      // anti-aliased lines
+    // helper methods
+    const Clip& clip() const { return clips.back(); }
+    Pixel* at(int x, int y) { return target->row(y-oy)+(x-ox); }
+    void plot(int x, int y);             // single clipped pixel
+    void brush(int x, int y);            // pixel or square of line width
+    void reset_dashes();
+    bool next_dash();                    // advance pattern, true if drawing
+    void axis_line(int x0, int y0, int x1, int y1);
+    void wu_line(int x0, int y0, int x1, int y1);
+    void wu_runs(int x0, int y0, int x1, int y1);
+    void blend_run(int y, int x, const uchar* cov, int n);
+    static int glyph_scale(Fl_Fontsize size);
+};
+
+}
+#endif /* Raster_hpp */
@@ -0,0 +1,125 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Scanline_fill.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+
+#include "Scanline_fill.hpp"
+
+#include <algorithm>
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+// a non horizontal side of the polygon crossing the rows [y0,y1);
+// it crosses the center of the current row at num/den+1/2, which
+// is kept exact so that the result does not depend on rounding
+struct Edge
+{
+    int y0, y1;
+    long long num, step, den;
+    int x;                      // first pixel right of the crossing
+};
+
+// smallest integer not below a/b, b > 0
+inline long long ceil_div(long long a, long long b)
+{
+    return (a >= 0) ? (a+b-1)/b : -((-a)/b);
+}
+
+}
+
+// constructor
+Scanline_fill::Scanline_fill(const Point* p, size_t n)
+{
+    // edge table sorted by first row
+    vector<Edge> et;
+    et.reserve(n);
+    for (size_t i=0; i < n; i++)
+    {
+        Point a = p[i];
+        Point b = p[(i+1) % n];
+        // horizontal sides do not cross any row center
+        if (a.y == b.y)
+            continue;
+        if (a.y > b.y)
+            swap(a,b);
+        // the center of row a.y is crossed at
+        // a.x + (b.x-a.x)/(2*(b.y-a.y))
+        long long den = 2LL*(b.y-a.y);
+        long long num = 2LL*a.x*(b.y-a.y) + (b.x-a.x) - (b.y-a.y);
+        et.push_back({a.y,b.y,num,2LL*(b.x-a.x),den,0});
+    }
+    sort(et.begin(),et.end(),[](const Edge& a, const Edge& b) { return a.y0 < b.y0; });
+    
+    // active edge table, kept sorted by x: the sides of a simple
+    // polygon do not cross, so the order only changes when edges
+    // come and go
+    vector<Edge> aet;
+    auto by_x = [](const Edge& a, const Edge& b) { return a.x < b.x; };
+    size_t next = 0;
+    int y = et.empty() ? 0 : et[0].y0;
+    while ( (next < et.size()) || !aet.empty() )
+    {
+        // skip the empty rows between two parts of the polygon
+        if (aet.empty())
+            y = max(y,et[next].y0);
+        // drop the edges which end above this row
+        aet.erase(remove_if(aet.begin(),aet.end(),[y](const Edge& e) { return e.y1 <= y; }),aet.end());
+        // merge the edges which start on this row
+        size_t old = aet.size();
+        while ( (next < et.size()) && (et[next].y0 == y) )
+        {
+            aet.push_back(et[next++]);
+            aet.back().x = int(ceil_div(aet.back().num,aet.back().den));
+        }
+        sort(aet.begin()+old,aet.end(),by_x);
+        inplace_merge(aet.begin(),aet.begin()+old,aet.end(),by_x);
+        // inside between the 1st and 2nd crossing, 3rd and 4th, ...
+        for (size_t k=0; k+1 < aet.size(); k += 2)
+            if (aet[k].x < aet[k+1].x)
+                spans.push_back({y,aet[k].x,aet[k+1].x});
+        // next row, edges meeting at a vertex may swap places:
+        // insertion sort is linear when nothing moved
+        for (auto& e : aet)
+        {
+            e.num += e.step;
+            e.x = int(ceil_div(e.num,e.den));
+        }
+        for (size_t k=1; k < aet.size(); k++)
+            for (size_t j=k; (j > 0) && (aet[j].x < aet[j-1].x); j--)
+                swap(aet[j],aet[j-1]);
+        y++;
+    }
+}
+
+} // namespace mathsophy::graphics
@@ -0,0 +1,75 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Scanline_fill.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+
+#ifndef Scanline_fill_hpp
+#define Scanline_fill_hpp
+
+#include <cstddef>
+#include <vector>
+
+#include "Graphics.hpp"
+#include "Raster.hpp"
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// Scanline fill
+//
+
+// the inside of a polygon as horizontal spans, found with an
+// active edge table: a pixel is inside when its center is
+// (even-odd rule); the spans are computed once by the
+// constructor in O(n log n + spans) and drawn many times
+class Scanline_fill
+{
+public:
+    // constructor, p[0..n) are the vertices of the polygon
+    Scanline_fill(const Point* p, size_t n);
+    // no copy constructor allowed
+    Scanline_fill(const Scanline_fill&) = delete;
+    // no copy assignment allowed
+    Scanline_fill& operator=(const Scanline_fill&) = delete;
+    // virtual destructor
+    virtual ~Scanline_fill() {}
+    // fills the spans with the current color of the raster
+    void render(Raster& r) const { r.spans(spans.data(),spans.size()); }
+    // getter methods
+    const vector<Span>& get_spans() const { return spans; }
+private:
+    vector<Span> spans;     // spans sorted by y, then by x
+};
+
+}
+#endif /* Scanline_fill_hpp */
@@ -0,0 +1,189 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Scene.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Scene.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace mathsophy::graphics
+{
+
+//
+// Scene
+//
+
+// show the shapes in a window too, in the order of attachment
+void Scene::attach_to(Generic_window& win) const
+{
+    for (auto s : shapes) win.attach(*s);
+}
+
+void Scene::detach_from(Generic_window& win) const
+{
+    for (auto s : shapes) win.detach(*s);
+}
+
+// render all the shapes in the order of attachment
+void Scene::render(Canvas& c) const
+{
+    c.resize(width,height);
+    c.clear(background);
+    Raster r{c};
+    r.antialias(antialias);
+    for (auto s : shapes) s->render(r);
+}
+
+// same result, the canvas is split into square tiles
+// of the given size which are rendered concurrently
+void Scene::render(Canvas& c, Thread_pool& pool, int tile) const
+{
+    if (tile <= 0)
+        throw runtime_error("Scene::render(): Tile size must be positive!");
+    c.resize(width,height);
+    int nx = (width+tile-1)/tile;
+    int ny = (height+tile-1)/tile;
+    // bin the shapes into the tiles touched by their render box,
+    // every bin keeps the order of attachment
+    vector< vector<Shape*> > bins(size_t(nx)*ny);
+    for (auto s : shapes)
+    {
+        if ( !s->is_visible() )
+            continue;
+        pair<Point,Point> box = s->get_render_box();
+        int tx0 = max(box.first.x,0)/tile;
+        int ty0 = max(box.first.y,0)/tile;
+        int tx1 = min(box.second.x-1,width-1)/tile;
+        int ty1 = min(box.second.y-1,height-1)/tile;
+        for (int ty=ty0; ty <= ty1; ty++)
+            for (int tx=tx0; tx <= tx1; tx++)
+                bins[size_t(ty)*nx+tx].push_back(s);
+    }
+    // the tiles do not overlap and every pixel sees the same
+    // shapes in the same order as in the single-threaded version
+    pool.parallel_for(bins.size(),[&](size_t i) {
+        int x = int(i % nx)*tile;
+        int y = int(i / nx)*tile;
+        Raster r{c};
+        r.antialias(antialias);
+        r.push_clip(x,y,tile,tile);
+        r.color(background);
+        r.rectf(x,y,tile,tile);
+        for (auto s : bins[i]) s->render(r);
+    });
+}
+
+//
+// Batch renderer
+//
+
+ostream& operator<<(ostream& os, const Batch_report& r)
+{
+    os << r.rendered << " charts in " << r.seconds << " s on "
+       << r.threads << " threads: " << r.charts_per_second() << " charts/s";
+    if (r.failed)
+        os << ", " << r.failed << " failed (" << r.first_error << ")";
+    return os;
+}
+
+// constructor
+Batch_renderer::Batch_renderer(int w, int h, unsigned threads) :
+    width{w}, height{h}, nb_threads{threads}
+{
+    if (nb_threads == 0)
+        nb_threads = max(1u,thread::hardware_concurrency());
+}
+
+// queue a scene
+void Batch_renderer::add(const string& fn, Scene_builder b)
+{
+    jobs.push_back(Job{fn,b});
+}
+
+// render all the queued scenes and empty the queue
+Batch_report Batch_renderer::run()
+{
+    Batch_report report;
+    mutex report_mutex;
+    atomic<size_t> next{0};
+    report.threads = unsigned(min(size_t(nb_threads),max(jobs.size(),size_t(1))));
+    auto start = chrono::steady_clock::now();
+    // the jobs are taken one at a time from a shared
+    // index, so slow scenes do not stall the others
+    vector<thread> workers;
+    for (unsigned i=0; i < report.threads; i++)
+        workers.emplace_back([&] { work(next,report,report_mutex); });
+    for (auto& t : workers) t.join();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    jobs.clear();
+    return report;
+}
+
+// loop of a worker thread
+void Batch_renderer::work(atomic<size_t>& next, Batch_report& report, mutex& report_mutex)
+{
+    // one canvas per worker, reused for all its scenes
+    Canvas canvas{width,height};
+    for (size_t i = next++; i < jobs.size(); i = next++)
+    {
+        unique_ptr<Scene> scene;
+        try
+        {
+            // FLTK is not thread-safe and shapes are FLTK widgets
+            // (text needs the font metrics too): building and
+            // deleting the scene is done one worker at a time,
+            // rasterizing and encoding run in parallel
+            {
+                lock_guard<mutex> lock{fltk_mutex};
+                scene = make_unique<Scene>(width,height);
+                jobs[i].build(*scene);
+            }
+            scene->render(canvas);
+            canvas.write(jobs[i].fn);
+            lock_guard<mutex> lock{report_mutex};
+            report.rendered++;
+        } catch (exception& e) {
+            lock_guard<mutex> lock{report_mutex};
+            if (report.failed++ == 0)
+                report.first_error = jobs[i].fn + ": " + e.what();
+        }
+        {
+            lock_guard<mutex> lock{fltk_mutex};
+            scene.reset();
+            // release whatever the builder captured
+            jobs[i].build = nullptr;
+        }
+    }
+}
+
+} // namespace mathsophy::graphics
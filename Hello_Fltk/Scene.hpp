@@ -0,0 +1,154 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Scene.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Scene_hpp
+#define Scene_hpp
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <mutex>
+
+#include "Graphics.hpp"
+#include "Raster.hpp"
+#include "Thread_pool.hpp"
+
+namespace mathsophy::graphics
+{
+
+//
+// Scene
+//
+
+// the headless counterpart of a window: a list of shapes
+// which is rendered into a canvas instead of the screen
+class Scene
+{
+public:
+    // constructor
+    Scene(int w, int h, Color_type bg = Color_type::white) :
+        width{w}, height{h}, background{to_fl_color(bg)} {}
+    // no copy constructor allowed
+    Scene(const Scene&) = delete;
+    // no copy assignment allowed
+    Scene& operator=(const Scene&) = delete;
+    // virtual destructor
+    virtual ~Scene() { for (auto s : owned) delete s; }
+    // attach a shape owned by the caller
+    void attach(Shape& s) { shapes.push_back(&s); }
+    // add a shape allocated with new, the scene deletes it
+    template<class T> T& add(T* s) {
+        owned.push_back(s);
+        shapes.push_back(s);
+        return *s;
+    }
+    // show the shapes in a window too, in the order of attachment
+    void attach_to(Generic_window& win) const;
+    void detach_from(Generic_window& win) const;
+    // render all the shapes in the order of attachment
+    void render(Canvas& c) const;
+    // same result, the canvas is split into square tiles of
+    // the given size which are rendered concurrently
+    void render(Canvas& c, Thread_pool& pool, int tile = 256) const;
+    // anti-aliased lines, off by default
+    void set_antialias(bool on) { antialias = on; }
+    // getter methods
+    int w() const { return width;  }
+    int h() const { return height; }
+    size_t get_nb_shapes() const { return shapes.size(); }
+    // i-th shape in the order of attachment, as a T
+    template<class T> T& get_shape(size_t i) const { return dynamic_cast<T&>(*shapes.at(i)); }
+private:
+    vector<Shape*> shapes;   // shapes to be rendered
+    vector<Shape*> owned;    // shapes to be deleted
+    int width{0};            // width in pixels
+    int height{0};           // height in pixels
+    Fl_Color background;     // color of the empty scene
+    bool antialias{false};   // anti-aliased lines
+};
+
+//
+// Batch renderer
+//
+
+// builds the shapes of one scene
+typedef std::function<void(Scene&)> Scene_builder;
+
+// outcome of a batch run
+struct Batch_report
+{
+    size_t rendered{0};      // files written
+    size_t failed{0};        // scenes which threw an exception
+    unsigned threads{0};     // worker threads used
+    double seconds{0};       // wall clock time
+    string first_error{};    // message of the first failure
+    double charts_per_second() const { return (seconds > 0) ? rendered/seconds : 0; }
+};
+
+ostream& operator<<(ostream& os, const Batch_report& r);
+
+// renders many independent scenes to image files using all
+// the cores: every worker holds one scene and one canvas at
+// a time, so the memory does not grow with the number of jobs
+class Batch_renderer
+{
+public:
+    // constructor, 0 threads means one per core
+    Batch_renderer(int w, int h, unsigned threads = 0);
+    // no copy constructor allowed
+    Batch_renderer(const Batch_renderer&) = delete;
+    // no copy assignment allowed
+    Batch_renderer& operator=(const Batch_renderer&) = delete;
+    // virtual destructor
+    virtual ~Batch_renderer() {}
+    // queue a scene, fn ends with .png or .ppm
+    void add(const string& fn, Scene_builder b);
+    // render all the queued scenes and empty the queue
+    Batch_report run();
+    // helper methods
+    size_t get_nb_jobs() const { return jobs.size(); }
+private:
+    struct Job
+    {
+        string fn;           // output file
+        Scene_builder build; // builder of the scene
+    };
+    vector<Job> jobs;        // queued scenes
+    int width{0};            // width of every scene
+    int height{0};           // height of every scene
+    unsigned nb_threads{0};  // worker threads
+    mutex fltk_mutex;        // serializes creation and deletion of shapes
+    // loop of a worker thread
+    void work(atomic<size_t>& next, Batch_report& report, mutex& report_mutex);
+};
+
+}
+#endif /* Scene_hpp */
@@ -0,0 +1,127 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Script.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Script.hpp"
+
+#include <algorithm>
+
+#include <FL/Fl.H>
+
+namespace mathsophy::graphics
+{
+
+//
+// Event waiters
+//
+
+// virtual destructor, the scripts still waiting are never resumed
+Event_waiters::~Event_waiters()
+{
+    for (auto a : waiters) a->source = nullptr;
+}
+
+// the event happened: every waiting script is resumed by the main loop
+void Event_waiters::notify()
+{
+    vector<Event_awaiter*> w;
+    w.swap(waiters);
+    for (auto a : w)
+    {
+        a->source = nullptr;
+        a->schedule(0);
+    }
+}
+
+//
+// Event awaiter
+//
+
+// virtual destructor, cancels the wait
+Event_awaiter::~Event_awaiter()
+{
+    if (scheduled)
+        Fl::remove_timeout(resume,this);
+    if (source)
+    {
+        auto& w = source->waiters;
+        w.erase(remove(w.begin(),w.end(),this),w.end());
+    }
+}
+
+void Event_awaiter::await_suspend(coroutine_handle<> h)
+{
+    handle = h;
+    if (source) source->waiters.push_back(this);
+    else schedule(delay);
+}
+
+// resume the script after t seconds
+void Event_awaiter::schedule(double t)
+{
+    scheduled = true;
+    Fl::add_timeout(t,resume,this);
+}
+
+void Event_awaiter::resume(void* a)
+{
+    Event_awaiter* e = static_cast<Event_awaiter*>(a);
+    e->scheduled = false;
+    e->handle.resume();
+}
+
+//
+// Script
+//
+
+// rethrow the exception thrown by the script, if any
+void Script::check() const
+{
+    if (h && h.done() && h.promise().error)
+        rethrow_exception(h.promise().error);
+}
+
+// runs the FLTK main loop until all the scripts are done,
+// the first exception thrown by a script is rethrown
+void run_scripts(vector<Script>& scripts)
+{
+    auto all_done = [&scripts] {
+        bool done = true;
+        for (auto& s : scripts)
+        {
+            s.check();
+            done = done && s.done();
+        }
+        return done;
+    };
+    while ( !all_done() ) Fl::wait();
+}
+
+} // namespace mathsophy::graphics
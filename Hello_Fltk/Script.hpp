@@ -0,0 +1,153 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Script.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Script_hpp
+#define Script_hpp
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+class Event_awaiter;
+
+//
+// Event waiters
+//
+
+// the scripts waiting for one event of a window or a widget,
+// owned by the window or widget which signals the event
+class Event_waiters
+{
+public:
+    // constructor
+    Event_waiters() {}
+    // no copy constructor allowed
+    Event_waiters(const Event_waiters&) = delete;
+    // no copy assignment allowed
+    Event_waiters& operator=(const Event_waiters&) = delete;
+    // virtual destructor, the scripts still
+    // waiting are never resumed
+    virtual ~Event_waiters();
+    // the event happened: every waiting script is
+    // resumed by the main loop, not by the caller
+    void notify();
+    // true if no script is waiting
+    bool empty() const { return waiters.empty(); }
+private:
+    friend class Event_awaiter;
+    vector<Event_awaiter*> waiters;
+};
+
+//
+// Event awaiter
+//
+
+// what a script co_awaits: the next notify() of some event
+// waiters, or the end of a delay; the script is resumed by
+// a zero timeout of the FLTK main loop, so that it never
+// runs inside the callback of a widget it may delete
+class Event_awaiter
+{
+public:
+    // waits for the next w.notify()
+    explicit Event_awaiter(Event_waiters& w) : source{&w} {}
+    // waits for t seconds
+    explicit Event_awaiter(double t) : delay{t} {}
+    // copies are only made before the script is suspended
+    Event_awaiter(const Event_awaiter& a) : source{a.source}, delay{a.delay} {}
+    Event_awaiter& operator=(const Event_awaiter&) = delete;
+    // virtual destructor, cancels the wait
+    virtual ~Event_awaiter();
+    // coroutine interface
+    bool await_ready() const { return false; }
+    void await_suspend(coroutine_handle<> h);
+    void await_resume() {}
+private:
+    friend class Event_waiters;
+    Event_waiters* source{nullptr}; // event waited for, if any
+    double delay{0};                // seconds waited for otherwise
+    coroutine_handle<> handle{};    // suspended script
+    bool scheduled{false};          // resume timeout pending
+    // resume the script after t seconds
+    void schedule(double t);
+    static void resume(void* a);
+};
+
+//
+// Script
+//
+
+// a coroutine which drives windows by waiting for their events
+// with co_await instead of nested event loops: it runs up to its
+// first co_await when called, then the FLTK main loop resumes it,
+// so any number of scripts share one thread and one loop
+class Script
+{
+public:
+    struct promise_type
+    {
+        exception_ptr error{};
+        Script get_return_object() {
+            return Script{coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = current_exception(); }
+    };
+    // move constructor
+    Script(Script&& s) : h{s.h} { s.h = nullptr; }
+    // no copy constructor allowed
+    Script(const Script&) = delete;
+    // no assignment allowed
+    Script& operator=(const Script&) = delete;
+    // virtual destructor, a script not done is cancelled
+    virtual ~Script() { if (h) h.destroy(); }
+    // true once the script has returned or thrown
+    bool done() const { return !h || h.done(); }
+    // rethrow the exception thrown by the script, if any
+    void check() const;
+private:
+    explicit Script(coroutine_handle<promise_type> c) : h{c} {}
+    coroutine_handle<promise_type> h;
+};
+
+// runs the FLTK main loop until all the scripts are done,
+// the first exception thrown by a script is rethrown
+void run_scripts(vector<Script>& scripts);
+
+}
+#endif /* Script_hpp */
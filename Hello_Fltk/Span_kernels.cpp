@@ -0,0 +1,436 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Span_kernels.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Span_kernels.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPAN_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define SPAN_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+//
+// Scalar kernels
+//
+
+void fill_scalar(Pixel* dst, size_t n, Pixel p)
+{
+    for (size_t i=0; i < n; i++)
+        dst[i] = p;
+}
+
+// shared by all the kernel types: a column touches one
+// pixel per row, there is nothing to vectorize
+void column_scalar(Pixel* dst, size_t n, ptrdiff_t stride, Pixel p)
+{
+    // unrolled by 4 to keep several stores in flight
+    for (; n >= 4; n -= 4, dst += 4*stride)
+    {
+        dst[0] = p;
+        dst[stride] = p;
+        dst[2*stride] = p;
+        dst[3*stride] = p;
+    }
+    for (; n > 0; n--, dst += stride)
+        *dst = p;
+}
+
+void blend_scalar(Pixel* dst, const uchar* cov, size_t n, Pixel p)
+{
+    for (size_t i=0; i < n; i++)
+        dst[i] = blend_pixel(dst[i],p,cov[i]);
+}
+
+void over_scalar(Pixel* dst, const Pixel* src, size_t n, unsigned a)
+{
+    if (a == 255)
+        for (size_t i=0; i < n; i++)
+            dst[i] = over_pixel(dst[i],src[i]);
+    else
+        for (size_t i=0; i < n; i++)
+            dst[i] = over_pixel(dst[i],premultiply(src[i],a));
+}
+
+// pixels before the first address aligned to a bytes
+size_t head(const Pixel* dst, size_t n, size_t a)
+{
+    size_t misalign = (reinterpret_cast<uintptr_t>(dst) & (a-1)) / sizeof(Pixel);
+    size_t k = misalign ? (a/sizeof(Pixel) - misalign) : 0;
+    return (k < n) ? k : n;
+}
+
+#if SPAN_KERNELS_X86
+
+//
+// SSE2 kernels
+//
+
+__attribute__((target("sse2")))
+void fill_sse2(Pixel* dst, size_t n, Pixel p)
+{
+    if (n < 4)
+        return fill_scalar(dst,n,p);
+    // one unaligned store covers the head
+    __m128i v = _mm_set1_epi32(int(p));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),v);
+    size_t k = head(dst,n,16);
+    dst += k; n -= k;
+    // 16 pixels per iteration with aligned stores
+    for (; n >= 16; n -= 16, dst += 16)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst),v);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst+4),v);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst+8),v);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst+12),v);
+    }
+    for (; n >= 4; n -= 4, dst += 4)
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst),v);
+    // one unaligned store, ending at the last pixel, covers the tail
+    if (n > 0)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+n-4),v);
+}
+
+// 4 pixels: 16-bit lanes, s*a + d*(255-a) rounded and divided by 255
+__attribute__((target("sse2")))
+inline __m128i blend4_sse2(__m128i d, __m128i s_lo, __m128i s_hi, __m128i a)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+    __m128i a_lo = _mm_unpacklo_epi8(a,zero), a_hi = _mm_unpackhi_epi8(a,zero);
+    __m128i d_lo = _mm_unpacklo_epi8(d,zero), d_hi = _mm_unpackhi_epi8(d,zero);
+    __m128i x_lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_lo,a_lo),
+                   _mm_mullo_epi16(d_lo,_mm_sub_epi16(full,a_lo))),half);
+    __m128i x_hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s_hi,a_hi),
+                   _mm_mullo_epi16(d_hi,_mm_sub_epi16(full,a_hi))),half);
+    x_lo = _mm_srli_epi16(_mm_add_epi16(x_lo,_mm_srli_epi16(x_lo,8)),8);
+    x_hi = _mm_srli_epi16(_mm_add_epi16(x_hi,_mm_srli_epi16(x_hi,8)),8);
+    return _mm_packus_epi16(x_lo,x_hi);
+}
+
+__attribute__((target("sse2")))
+void blend_sse2(Pixel* dst, const uchar* cov, size_t n, Pixel p)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_set1_epi32(int(p));
+    __m128i s_lo = _mm_unpacklo_epi8(s,zero), s_hi = _mm_unpackhi_epi8(s,zero);
+    size_t i = 0;
+    for (; i+4 <= n; i += 4)
+    {
+        // coverage of every pixel spread over its 4 channels
+        int c;
+        memcpy(&c,cov+i,4);
+        __m128i a = _mm_cvtsi32_si128(c);
+        a = _mm_unpacklo_epi8(a,a);
+        a = _mm_unpacklo_epi16(a,a);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst+i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),blend4_sse2(d,s_lo,s_hi,a));
+    }
+    blend_scalar(dst+i,cov+i,n-i,p);
+}
+
+// 2 pixels in 16-bit lanes: d*b rounded and divided by 255
+__attribute__((target("sse2")))
+inline __m128i scale2_sse2(__m128i d, __m128i b)
+{
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(d,b),_mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x,_mm_srli_epi16(x,8)),8);
+}
+
+__attribute__((target("sse2")))
+void over_sse2(Pixel* dst, const Pixel* src, size_t n, unsigned a)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i op = _mm_set1_epi16(short(a));
+    size_t i = 0;
+    for (; i+4 <= n; i += 4)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst+i));
+        __m128i s_lo = _mm_unpacklo_epi8(s,zero), s_hi = _mm_unpackhi_epi8(s,zero);
+        if (a != 255)
+        {
+            s_lo = scale2_sse2(s_lo,op);
+            s_hi = scale2_sse2(s_hi,op);
+        }
+        // 255 minus the alpha of every source pixel, on its 4 channels
+        __m128i b_lo = _mm_sub_epi16(full,_mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo,0xff),0xff));
+        __m128i b_hi = _mm_sub_epi16(full,_mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi,0xff),0xff));
+        __m128i x_lo = _mm_add_epi16(s_lo,scale2_sse2(_mm_unpacklo_epi8(d,zero),b_lo));
+        __m128i x_hi = _mm_add_epi16(s_hi,scale2_sse2(_mm_unpackhi_epi8(d,zero),b_hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_mm_packus_epi16(x_lo,x_hi));
+    }
+    over_scalar(dst+i,src+i,n-i,a);
+}
+
+//
+// AVX2 kernels
+//
+
+__attribute__((target("avx2")))
+void fill_avx2(Pixel* dst, size_t n, Pixel p)
+{
+    if (n < 8)
+        return fill_scalar(dst,n,p);
+    // one unaligned store covers the head
+    __m256i v = _mm256_set1_epi32(int(p));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),v);
+    size_t k = head(dst,n,32);
+    dst += k; n -= k;
+    // 32 pixels per iteration with aligned stores
+    for (; n >= 32; n -= 32, dst += 32)
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst),v);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst+8),v);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst+16),v);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst+24),v);
+    }
+    for (; n >= 8; n -= 8, dst += 8)
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst),v);
+    // one unaligned store, ending at the last pixel, covers the tail
+    if (n > 0)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+n-8),v);
+}
+
+__attribute__((target("avx2")))
+void blend_avx2(Pixel* dst, const uchar* cov, size_t n, Pixel p)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m256i half = _mm256_set1_epi16(128);
+    // byte k of every pixel takes the coverage of that pixel
+    const __m256i spread = _mm256_setr_epi8(0,0,0,0,4,4,4,4,8,8,8,8,12,12,12,12,
+                                            0,0,0,0,4,4,4,4,8,8,8,8,12,12,12,12);
+    __m256i s = _mm256_set1_epi32(int(p));
+    __m256i s_lo = _mm256_unpacklo_epi8(s,zero), s_hi = _mm256_unpackhi_epi8(s,zero);
+    size_t i = 0;
+    for (; i+8 <= n; i += 8)
+    {
+        __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(cov+i));
+        __m256i a = _mm256_shuffle_epi8(_mm256_cvtepu8_epi32(c),spread);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst+i));
+        __m256i a_lo = _mm256_unpacklo_epi8(a,zero), a_hi = _mm256_unpackhi_epi8(a,zero);
+        __m256i d_lo = _mm256_unpacklo_epi8(d,zero), d_hi = _mm256_unpackhi_epi8(d,zero);
+        __m256i x_lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s_lo,a_lo),
+                       _mm256_mullo_epi16(d_lo,_mm256_sub_epi16(full,a_lo))),half);
+        __m256i x_hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s_hi,a_hi),
+                       _mm256_mullo_epi16(d_hi,_mm256_sub_epi16(full,a_hi))),half);
+        x_lo = _mm256_srli_epi16(_mm256_add_epi16(x_lo,_mm256_srli_epi16(x_lo,8)),8);
+        x_hi = _mm256_srli_epi16(_mm256_add_epi16(x_hi,_mm256_srli_epi16(x_hi,8)),8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i),_mm256_packus_epi16(x_lo,x_hi));
+    }
+    blend_scalar(dst+i,cov+i,n-i,p);
+}
+
+// 4 pixels in 16-bit lanes: d*b rounded and divided by 255
+__attribute__((target("avx2")))
+inline __m256i scale4_avx2(__m256i d, __m256i b)
+{
+    __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(d,b),_mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x,_mm256_srli_epi16(x,8)),8);
+}
+
+__attribute__((target("avx2")))
+void over_avx2(Pixel* dst, const Pixel* src, size_t n, unsigned a)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m256i op = _mm256_set1_epi16(short(a));
+    size_t i = 0;
+    for (; i+8 <= n; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst+i));
+        __m256i s_lo = _mm256_unpacklo_epi8(s,zero), s_hi = _mm256_unpackhi_epi8(s,zero);
+        if (a != 255)
+        {
+            s_lo = scale4_avx2(s_lo,op);
+            s_hi = scale4_avx2(s_hi,op);
+        }
+        // 255 minus the alpha of every source pixel, on its 4 channels
+        __m256i b_lo = _mm256_sub_epi16(full,_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_lo,0xff),0xff));
+        __m256i b_hi = _mm256_sub_epi16(full,_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_hi,0xff),0xff));
+        __m256i x_lo = _mm256_add_epi16(s_lo,scale4_avx2(_mm256_unpacklo_epi8(d,zero),b_lo));
+        __m256i x_hi = _mm256_add_epi16(s_hi,scale4_avx2(_mm256_unpackhi_epi8(d,zero),b_hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i),_mm256_packus_epi16(x_lo,x_hi));
+    }
+    over_scalar(dst+i,src+i,n-i,a);
+}
+
+#endif
+
+#if SPAN_KERNELS_NEON
+
+//
+// NEON kernels
+//
+
+// 2 pixels in 16-bit lanes: x rounded and divided by 255
+inline uint8x8_t div255_neon(uint16x8_t x)
+{
+    return vraddhn_u16(x,vrshrq_n_u16(x,8));
+}
+
+void fill_neon(Pixel* dst, size_t n, Pixel p)
+{
+    if (n < 4)
+        return fill_scalar(dst,n,p);
+    uint32x4_t v = vdupq_n_u32(p);
+    // 16 pixels per iteration
+    for (; n >= 16; n -= 16, dst += 16)
+    {
+        vst1q_u32(dst,v);
+        vst1q_u32(dst+4,v);
+        vst1q_u32(dst+8,v);
+        vst1q_u32(dst+12,v);
+    }
+    for (; n >= 4; n -= 4, dst += 4)
+        vst1q_u32(dst,v);
+    // one store, ending at the last pixel, covers the tail
+    if (n > 0)
+        vst1q_u32(dst+n-4,v);
+}
+
+void blend_neon(Pixel* dst, const uchar* cov, size_t n, Pixel p)
+{
+    uint8x8_t s = vreinterpret_u8_u32(vdup_n_u32(p));
+    // byte k of every pixel takes the coverage of that pixel
+    const uint8x8_t spread = {0,0,0,0,1,1,1,1};
+    size_t i = 0;
+    for (; i+2 <= n; i += 2)
+    {
+        uint8x8_t a = vtbl1_u8(vreinterpret_u8_u16(vld1_dup_u16(reinterpret_cast<const uint16_t*>(cov+i))),spread);
+        uint8x8_t d = vreinterpret_u8_u32(vld1_u32(dst+i));
+        uint16x8_t x = vmlal_u8(vmull_u8(s,a),d,vmvn_u8(a));
+        vst1_u32(dst+i,vreinterpret_u32_u8(div255_neon(x)));
+    }
+    blend_scalar(dst+i,cov+i,n-i,p);
+}
+
+void over_neon(Pixel* dst, const Pixel* src, size_t n, unsigned a)
+{
+    // byte k of every pixel takes the alpha of that pixel
+    const uint8x8_t spread = {3,3,3,3,7,7,7,7};
+    uint8x8_t op = vdup_n_u8(uchar(a));
+    size_t i = 0;
+    for (; i+2 <= n; i += 2)
+    {
+        uint8x8_t s = vreinterpret_u8_u32(vld1_u32(src+i));
+        if (a != 255)
+            s = div255_neon(vmull_u8(s,op));
+        uint8x8_t b = vmvn_u8(vtbl1_u8(s,spread));
+        uint8x8_t d = vreinterpret_u8_u32(vld1_u32(dst+i));
+        vst1_u32(dst+i,vreinterpret_u32_u8(vadd_u8(s,div255_neon(vmull_u8(d,b)))));
+    }
+    over_scalar(dst+i,src+i,n-i,a);
+}
+
+#endif
+
+const Span_kernels scalar_kernels{Kernel_type::scalar,"scalar",
+    fill_scalar,column_scalar,blend_scalar,over_scalar};
+#if SPAN_KERNELS_X86
+const Span_kernels sse2_kernels{Kernel_type::sse2,"sse2",
+    fill_sse2,column_scalar,blend_sse2,over_sse2};
+const Span_kernels avx2_kernels{Kernel_type::avx2,"avx2",
+    fill_avx2,column_scalar,blend_avx2,over_avx2};
+#endif
+#if SPAN_KERNELS_NEON
+const Span_kernels neon_kernels{Kernel_type::neon,"neon",
+    fill_neon,column_scalar,blend_neon,over_neon};
+#endif
+
+}
+
+// true if the CPU running the program can use the kernels
+bool kernel_supported(Kernel_type t)
+{
+    switch (t) {
+        case Kernel_type::scalar:
+            return true;
+#if SPAN_KERNELS_X86
+        case Kernel_type::sse2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel_type::avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if SPAN_KERNELS_NEON
+        case Kernel_type::neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+// the kernels of a given type, throws if not supported
+const Span_kernels& span_kernels(Kernel_type t)
+{
+    if (!kernel_supported(t))
+        throw runtime_error("span_kernels(): Kernel type not supported by this CPU!");
+    switch (t) {
+#if SPAN_KERNELS_X86
+        case Kernel_type::sse2: return sse2_kernels;
+        case Kernel_type::avx2: return avx2_kernels;
+#endif
+#if SPAN_KERNELS_NEON
+        case Kernel_type::neon: return neon_kernels;
+#endif
+        default: return scalar_kernels;
+    }
+}
+
+// the fastest kernels for this CPU, chosen once at the first call
+const Span_kernels& span_kernels()
+{
+    static const Span_kernels& best = [] () -> const Span_kernels& {
+        for (Kernel_type t : {Kernel_type::avx2,Kernel_type::neon,Kernel_type::sse2})
+            if (kernel_supported(t))
+                return span_kernels(t);
+        return scalar_kernels;
+    }();
+    return best;
+}
+
+} // namespace mathsophy::graphics
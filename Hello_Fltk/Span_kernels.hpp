@@ -0,0 +1,88 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Span_kernels.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Span_kernels_hpp
+#define Span_kernels_hpp
+
+#include <cstddef>
+
+#include "Raster.hpp"
+
+namespace mathsophy::graphics
+{
+
+//
+// kernel enumerations
+//
+
+enum class Kernel_type
+{
+    scalar,   // plain loops, always available
+    sse2,     // 4 pixels per store (x86)
+    avx2,     // 8 pixels per store (x86)
+    neon      // 4 pixels per store (ARM)
+};
+
+//
+// Span kernels
+//
+
+// the innermost loops of the software render path: solid
+// horizontal spans (filled rectangles, horizontal lines),
+// columns (vertical lines), spans blended with a coverage
+// per pixel (anti-aliased lines) and premultiplied pixels
+// composited over the canvas (translucent layers and images)
+struct Span_kernels
+{
+    Kernel_type type;
+    const char* name;
+    // fill n consecutive pixels with p
+    void (*fill)(Pixel* dst, size_t n, Pixel p);
+    // fill n pixels, one every stride pixels, with p
+    void (*column)(Pixel* dst, size_t n, ptrdiff_t stride, Pixel p);
+    // draw p over n consecutive pixels, pixel i with coverage cov[i]
+    void (*blend)(Pixel* dst, const uchar* cov, size_t n, Pixel p);
+    // draw the premultiplied pixels src over n consecutive
+    // pixels, with the opacity a (0 to 255)
+    void (*over)(Pixel* dst, const Pixel* src, size_t n, unsigned a);
+};
+
+// true if the CPU running the program can use the kernels
+bool kernel_supported(Kernel_type t);
+
+// the kernels of a given type, throws if not supported
+const Span_kernels& span_kernels(Kernel_type t);
+
+// the fastest kernels for this CPU, chosen once at the first call
+const Span_kernels& span_kernels();
+
+}
+#endif /* Span_kernels_hpp */
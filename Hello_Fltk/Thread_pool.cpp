@@ -0,0 +1,158 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Thread_pool.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Thread_pool.hpp"
+
+namespace mathsophy::graphics
+{
+
+//
+// Thread pool
+//
+
+// constructor
+Thread_pool::Thread_pool(unsigned threads)
+{
+    if (threads == 0)
+        threads = max(1u,thread::hardware_concurrency());
+    for (unsigned i=0; i < threads; i++)
+        queues.push_back(make_unique<Queue>());
+    for (unsigned i=0; i < threads; i++)
+        workers.emplace_back([this,i] { work(i); });
+}
+
+// virtual destructor, waits for the running tasks
+Thread_pool::~Thread_pool()
+{
+    {
+        unique_lock<mutex> lock{state_mutex};
+        done.wait(lock,[this] { return pending == 0; });
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+// queue a task, the queues are filled round robin
+void Thread_pool::submit(function<void()> task)
+{
+    {
+        // counted before the push so that queued never goes
+        // below zero, under the lock so that a worker about
+        // to sleep cannot miss it
+        lock_guard<mutex> lock{state_mutex};
+        pending++;
+        queued++;
+    }
+    Queue& q = *queues[next_queue++ % queues.size()];
+    {
+        lock_guard<mutex> lock{q.m};
+        q.tasks.push_back(move(task));
+    }
+    wake.notify_one();
+}
+
+// wait until all the submitted tasks are done,
+// the first exception thrown by a task is rethrown
+void Thread_pool::wait()
+{
+    unique_lock<mutex> lock{state_mutex};
+    done.wait(lock,[this] { return pending == 0; });
+    if (error)
+    {
+        exception_ptr e = error;
+        error = nullptr;
+        rethrow_exception(e);
+    }
+}
+
+// run f(0),...,f(n-1) and wait for all of them
+void Thread_pool::parallel_for(size_t n, const function<void(size_t)>& f)
+{
+    for (size_t i=0; i < n; i++)
+        submit([&f,i] { f(i); });
+    wait();
+}
+
+// loop of a worker thread
+void Thread_pool::work(size_t i)
+{
+    function<void()> task;
+    for (;;)
+    {
+        if (take(i,task))
+        {
+            exception_ptr e;
+            try { task(); }
+            catch (...) { e = current_exception(); }
+            task = nullptr;
+            lock_guard<mutex> lock{state_mutex};
+            if (e && !error)
+                error = e;
+            if (--pending == 0)
+                done.notify_all();
+            continue;
+        }
+        unique_lock<mutex> lock{state_mutex};
+        wake.wait(lock,[this] { return stop || (queued > 0); });
+        if (stop && (queued == 0))
+            return;
+    }
+}
+
+// take a task: newest of the own queue, else
+// oldest of the first other queue with work
+bool Thread_pool::take(size_t i, function<void()>& task)
+{
+    for (size_t k=0; k < queues.size(); k++)
+    {
+        Queue& q = *queues[(i+k) % queues.size()];
+        lock_guard<mutex> lock{q.m};
+        if (q.tasks.empty())
+            continue;
+        if (k == 0)
+        {
+            task = move(q.tasks.back());
+            q.tasks.pop_back();
+        }
+        else
+        {
+            task = move(q.tasks.front());
+            q.tasks.pop_front();
+            steals++;
+        }
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+} // namespace mathsophy::graphics
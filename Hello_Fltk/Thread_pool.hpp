@@ -0,0 +1,102 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Thread_pool.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Thread_pool_hpp
+#define Thread_pool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// Thread pool
+//
+
+// fixed set of worker threads, every worker has its own queue
+// of tasks: it takes new work from the back of its queue and,
+// when empty, steals from the front of the queues of the others
+class Thread_pool
+{
+public:
+    // constructor, 0 threads means one per core
+    Thread_pool(unsigned threads = 0);
+    // no copy constructor allowed
+    Thread_pool(const Thread_pool&) = delete;
+    // no copy assignment allowed
+    Thread_pool& operator=(const Thread_pool&) = delete;
+    // virtual destructor, waits for the running tasks
+    virtual ~Thread_pool();
+    // queue a task, the queues are filled round robin
+    void submit(function<void()> task);
+    // wait until all the submitted tasks are done,
+    // the first exception thrown by a task is rethrown
+    void wait();
+    // run f(0),...,f(n-1) and wait for all of them
+    void parallel_for(size_t n, const function<void(size_t)>& f);
+    // getter methods
+    unsigned size() const { return unsigned(workers.size()); }
+    size_t get_nb_steals() const { return steals; }
+private:
+    struct Queue
+    {
+        mutex m;
+        deque< function<void()> > tasks;
+    };
+    vector< unique_ptr<Queue> > queues;  // one queue per worker
+    vector<thread> workers;              // worker threads
+    atomic<size_t> next_queue{0};        // round robin index for submit
+    atomic<size_t> queued{0};            // tasks waiting in the queues
+    atomic<size_t> pending{0};           // tasks submitted and not finished
+    atomic<size_t> steals{0};            // tasks taken from another queue
+    bool stop{false};                    // set by the destructor
+    exception_ptr error{};               // first exception of a task
+    mutex state_mutex;                   // protects stop, error and the sleeps
+    condition_variable wake;             // signals new tasks
+    condition_variable done;             // signals pending == 0
+    // loop of a worker thread
+    void work(size_t i);
+    // take a task, own queue first
+    bool take(size_t i, function<void()>& task);
+};
+
+}
+#endif /* Thread_pool_hpp */
@@ -0,0 +1,270 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tiled_image.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#include "Tiled_image.hpp"
+#include "Raster.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+//
+// Tile file
+//
+
+// a 32 bytes header, then the tiles row after row, each one
+// tile x tile pixels (the tiles on the right and bottom edges
+// are padded), so that a tile is a contiguous block of the file
+struct Tile_header
+{
+    char magic[8];
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile;
+    uint32_t depth;
+    uint32_t reserved[2];
+};
+
+const char tile_magic[8] = {'H','F','T','I','L','E','S','1'};
+
+// tile states
+const uint8_t tile_prefetched = 1;
+const uint8_t tile_drawn      = 2;
+
+}
+
+//
+// Tiled image
+//
+
+// constructor
+Tiled_image::Tiled_image(Point pos, string name, int w, int h) : fn{name}
+{
+    fd = open(fn.c_str(),O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("Tiled_image::Tiled_image(): File " + fn + " not found!");
+    struct stat st;
+    Tile_header hd;
+    if ( (fstat(fd,&st) != 0) || (pread(fd,&hd,sizeof(hd),0) != ssize_t(sizeof(hd))) ||
+         (memcmp(hd.magic,tile_magic,sizeof(tile_magic)) != 0) ||
+         (hd.width == 0) || (hd.height == 0) || (hd.tile == 0) ||
+         ((hd.depth != 3) && (hd.depth != 4)) )
+    {
+        close(fd);
+        throw runtime_error("Tiled_image::Tiled_image(): File " + fn + " format error!");
+    }
+    width = int(hd.width);
+    height = int(hd.height);
+    tile = int(hd.tile);
+    depth = int(hd.depth);
+    tiles_x = (width+tile-1)/tile;
+    tiles_y = (height+tile-1)/tile;
+    map_size = sizeof(hd) + size_t(tiles_x)*tiles_y*tile*tile*depth;
+    if (size_t(st.st_size) < map_size)
+    {
+        close(fd);
+        throw runtime_error("Tiled_image::Tiled_image(): File " + fn + " format error!");
+    }
+    // nothing is read until a tile is drawn or prefetched
+    void* m = mmap(nullptr,map_size,PROT_READ,MAP_SHARED,fd,0);
+    if (m == MAP_FAILED)
+    {
+        close(fd);
+        throw runtime_error("Tiled_image::Tiled_image(): File " + fn + " access error!");
+    }
+    map = static_cast<uchar*>(m);
+    madvise(map,map_size,MADV_RANDOM);
+    state.assign(size_t(tiles_x)*tiles_y,0);
+    resize_widget(pos,Point{pos.x+w,pos.y+h});
+    prefetch();
+}
+
+// virtual destructor
+Tiled_image::~Tiled_image()
+{
+    if (map) munmap(map,map_size);
+    if (fd >= 0) close(fd);
+}
+
+// set visible area: the part of the image at o is shown
+void Tiled_image::set_mask(Point o, int w, int h)
+{
+    heading = Point{0,0};
+    orig = o;
+    resize_widget(get_tl(),Point{get_tl().x+w,get_tl().y+h});
+    prefetch();
+}
+
+// move the visible area over the image by dx,dy
+void Tiled_image::pan(int dx, int dy)
+{
+    heading = Point{(dx > 0) - (dx < 0),(dy > 0) - (dy < 0)};
+    orig = Point{orig.x+dx,orig.y+dy};
+    prefetch();
+}
+
+Tiled_image_stats Tiled_image::get_stats() const
+{
+    Tiled_image_stats s;
+    lock_guard<mutex> lock{state_mutex};
+    s.tiles = state.size();
+    for (auto t : state)
+    {
+        if (t & tile_drawn) s.tiles_drawn++;
+        if (t & tile_prefetched) s.tiles_prefetched++;
+    }
+    return s;
+}
+
+// write the w x h image in buf as a tile file for Tiled_image
+void Tiled_image::write_tiles(const string& fn, const uchar* buf, int w, int h,
+                              int d, int ld, int tile)
+{
+    if ( !buf || (w <= 0) || (h <= 0) || (tile <= 0) || ((d != 3) && (d != 4)) )
+        throw runtime_error("Tiled_image::write_tiles(): Invalid image!");
+    if (ld == 0) ld = w*d;
+    ofstream out{fn,ios::binary};
+    if (!out)
+        throw runtime_error("Tiled_image::write_tiles(): File " + fn + " access error!");
+    Tile_header hd{};
+    memcpy(hd.magic,tile_magic,sizeof(tile_magic));
+    hd.width = uint32_t(w);
+    hd.height = uint32_t(h);
+    hd.tile = uint32_t(tile);
+    hd.depth = uint32_t(d);
+    out.write(reinterpret_cast<const char*>(&hd),sizeof(hd));
+    vector<char> line(size_t(tile)*d,0);
+    for (int ty=0; ty < h; ty += tile)
+        for (int tx=0; tx < w; tx += tile)
+        {
+            int tw = min(tile,w-tx);
+            for (int y=ty; y < ty+tile; y++)
+            {
+                // padding on the edges
+                fill(line.begin(),line.end(),0);
+                if (y < h)
+                    memcpy(line.data(),buf + size_t(y)*ld + size_t(tx)*d,size_t(tw)*d);
+                out.write(line.data(),line.size());
+            }
+        }
+    if (!out)
+        throw runtime_error("Tiled_image::write_tiles(): File " + fn + " access error!");
+}
+
+// overridden member methods
+void Tiled_image::draw_shape()
+{
+    for_each_visible([this](const uchar* p, int ld, int x, int y, int w, int h) {
+        fl_draw_image(p,x,y,w,h,depth,ld);
+    });
+}
+
+void Tiled_image::move_shape(int dx,int dy)
+{
+    resize_widget(Point{get_tl().x+dx,get_tl().y+dy},
+                 Point{get_tl().x+dx+get_w(),
+                 get_tl().y+dy+get_h()});
+}
+
+void Tiled_image::render_shape(Raster& r) const
+{
+    for_each_visible([this,&r](const uchar* p, int ld, int x, int y, int w, int h) {
+        r.draw_image(p,depth,ld,x,y,w,h);
+    });
+}
+
+// helper methods
+const uchar* Tiled_image::tile_pixels(int tx, int ty) const
+{
+    return map + sizeof(Tile_header) + (size_t(ty)*tiles_x + tx)*tile*tile*depth;
+}
+
+// the tiles around the visible ones are read ahead by the
+// system, one more row or column in the direction of panning
+void Tiled_image::prefetch()
+{
+    int tx0 = max(orig.x,0)/tile - 1 + min(heading.x,0);
+    int ty0 = max(orig.y,0)/tile - 1 + min(heading.y,0);
+    int tx1 = (orig.x+get_w()-1)/tile + 1 + max(heading.x,0);
+    int ty1 = (orig.y+get_h()-1)/tile + 1 + max(heading.y,0);
+    long page = sysconf(_SC_PAGESIZE);
+    size_t bytes = size_t(tile)*tile*depth;
+    lock_guard<mutex> lock{state_mutex};
+    for (int ty=max(ty0,0); ty <= min(ty1,tiles_y-1); ty++)
+        for (int tx=max(tx0,0); tx <= min(tx1,tiles_x-1); tx++)
+        {
+            uint8_t& s = state[size_t(ty)*tiles_x + tx];
+            if (s) continue;
+            s |= tile_prefetched;
+            // madvise wants a page aligned start
+            uintptr_t a = uintptr_t(tile_pixels(tx,ty));
+            uintptr_t b = a & ~uintptr_t(page-1);
+            madvise(reinterpret_cast<void*>(b),bytes + (a-b),MADV_WILLNEED);
+        }
+}
+
+// calls f(pixels, ld, x, y, w, h) for the visible part of every
+// tile under the visible area, x and y are view coordinates
+template<class F> void Tiled_image::for_each_visible(F f) const
+{
+    // visible area clipped to the image
+    int x0 = max(orig.x,0), y0 = max(orig.y,0);
+    int x1 = min(orig.x+get_w(),width), y1 = min(orig.y+get_h(),height);
+    int ld = tile*depth;
+    for (int ty=y0/tile; (ty < tiles_y) && (ty*tile < y1); ty++)
+        for (int tx=x0/tile; (tx < tiles_x) && (tx*tile < x1); tx++)
+        {
+            int ax = max(x0,tx*tile), ay = max(y0,ty*tile);
+            int bx = min(x1,(tx+1)*tile), by = min(y1,(ty+1)*tile);
+            if ( (ax >= bx) || (ay >= by) )
+                continue;
+            {
+                lock_guard<mutex> lock{state_mutex};
+                state[size_t(ty)*tiles_x + tx] |= tile_drawn;
+            }
+            const uchar* p = tile_pixels(tx,ty) + size_t(ay-ty*tile)*ld + size_t(ax-tx*tile)*depth;
+            f(p,ld,get_tl().x+ax-orig.x,get_tl().y+ay-orig.y,bx-ax,by-ay);
+        }
+}
+
+} // namespace mathsophy::graphics
@@ -0,0 +1,116 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tiled_image.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+#ifndef Tiled_image_hpp
+#define Tiled_image_hpp
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Graphics.hpp"
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// Tiled image statistics
+//
+
+struct Tiled_image_stats
+{
+    size_t tiles{0};            // tiles in the file
+    size_t tiles_drawn{0};      // tiles drawn at least once
+    size_t tiles_prefetched{0}; // tiles read ahead before being drawn
+};
+
+//
+// Tiled image
+//
+
+// an image far larger than the memory: the pixels are stored as
+// square tiles in a raw file which is mapped into memory, only the
+// tiles under the visible area are read and drawn, the tiles next
+// to them (and further in the direction of panning) are read ahead
+class Tiled_image : public Shape
+{
+public:
+    // constructor, the image in file fn is shown in
+    // a view of size w x h with its origin at the top left
+    Tiled_image(Point pos, string fn, int w, int h);
+    // virtual destructor
+    virtual ~Tiled_image();
+    // set visible area: the part of the image at o is shown
+    void set_mask(Point o, int w, int h);
+    // move the visible area over the image by dx,dy
+    // (call of redraw() might be needed)
+    void pan(int dx, int dy);
+    // getter methods
+    Point get_orig() const { return orig; }
+    int image_w() const { return width; }
+    int image_h() const { return height; }
+    int get_tile_size() const { return tile; }
+    Tiled_image_stats get_stats() const;
+    // write the w x h image in buf (d channels, 3 or 4, and ld bytes
+    // per line, 0 means w*d) as a tile file for Tiled_image
+    static void write_tiles(const string& fn, const uchar* buf, int w, int h,
+                            int d, int ld = 0, int tile = 256);
+protected:
+    // overridden member methods
+    void draw_shape();
+    void move_shape(int dx,int dy);
+    void render_shape(Raster& r) const;
+private:
+    string fn{};                  // file name
+    int fd{-1};                   // file descriptor
+    uchar* map{nullptr};          // mapped file
+    size_t map_size{0};           // size of the mapping
+    int width{0}, height{0};      // image size
+    int tile{0};                  // tile size in pixels
+    int depth{0};                 // channels, 3 or 4
+    int tiles_x{0}, tiles_y{0};   // tiles per row and per column
+    Point orig{};                 // origin of the visible area
+    Point heading{};              // sign of the last pan
+    mutable vector<uint8_t> state;// per tile: read ahead, drawn
+    mutable mutex state_mutex;    // tiles may be rendered concurrently
+    // helper methods
+    const uchar* tile_pixels(int tx, int ty) const;
+    void prefetch();
+    // calls f(pixels, ld, x, y, w, h) for the visible part of every
+    // tile under the visible area, x and y are view coordinates
+    template<class F> void for_each_visible(F f) const;
+};
+
+}
+#endif /* Tiled_image_hpp */
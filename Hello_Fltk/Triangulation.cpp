@@ -0,0 +1,262 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Triangulation.cpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+
+#include "Triangulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mathsophy::graphics
+{
+
+namespace
+{
+
+// twice the signed area of the triangle a,b,c
+inline long long cross(Point a, Point b, Point c)
+{
+    return (long long)(b.x-a.x)*(c.y-a.y) - (long long)(b.y-a.y)*(c.x-a.x);
+}
+
+}
+
+// calls f with the index of every cell which the triangle a,b,c
+// overlaps: the triangle is cut into the bands of the rows of the
+// grid, so that a long and thin triangle only visits the cells
+// along it; the bands are widened by half a pixel against rounding
+template<class F>
+void Triangulation::for_each_cell(Point a, Point b, Point c, F f) const
+{
+    const Point v[3]{a,b,c};
+    size_t y0 = size_t((min({a.y,b.y,c.y})-tl.y)/cell);
+    size_t y1 = size_t((max({a.y,b.y,c.y})-tl.y)/cell);
+    for (size_t y=y0; y <= y1; y++)
+    {
+        double ya = tl.y+y*cell-0.5, yb = tl.y+(y+1)*cell+0.5;
+        double xmin = HUGE_VAL, xmax = -HUGE_VAL;
+        for (int i=0; i < 3; i++)
+        {
+            // the part of the side p,q inside the band
+            Point p = v[i], q = v[(i+1) % 3];
+            double lo = max(ya,double(min(p.y,q.y)));
+            double hi = min(yb,double(max(p.y,q.y)));
+            if (lo > hi)
+                continue;
+            double xl = p.x, xh = q.x;
+            if (p.y != q.y)
+            {
+                double dx = double(q.x-p.x)/(q.y-p.y);
+                xl = p.x+(lo-p.y)*dx;
+                xh = p.x+(hi-p.y)*dx;
+            }
+            xmin = min({xmin,xl,xh});
+            xmax = max({xmax,xl,xh});
+        }
+        if (xmin > xmax)
+            continue;
+        size_t x0 = size_t(max(0.0,(xmin-0.5-tl.x)/cell));
+        size_t x1 = min(cols-1,size_t(max(0.0,(xmax+0.5-tl.x)/cell)));
+        for (size_t x=x0; x <= x1; x++)
+            f(y*cols+x);
+    }
+}
+
+// constructor
+Triangulation::Triangulation(const Point* p, size_t n) : pts{p}
+{
+    if (n < 3)
+        return;
+    
+    // grid of about one vertex per cell
+    tl = p[0];
+    Point br = p[0];
+    for (size_t i=0; i < n; i++)
+    {
+        tl.x = min(tl.x,p[i].x); tl.y = min(tl.y,p[i].y);
+        br.x = max(br.x,p[i].x); br.y = max(br.y,p[i].y);
+    }
+    double w = double(br.x)-tl.x+1, h = double(br.y)-tl.y+1;
+    cell = max({sqrt(w*h/n),max(w,h)/n,1.0});
+    cols = size_t(w/cell)+1;
+    rows = size_t(h/cell)+1;
+    
+    clip_ears(n);
+    bin_triangles();
+    
+    // area and center of mass summed over the triangles
+    double sx = 0, sy = 0;
+    for (size_t t=0; t < indices.size(); t += 3)
+    {
+        Point a = p[indices[t]], b = p[indices[t+1]], c = p[indices[t+2]];
+        double at = fabs(double(cross(a,b,c)))/2;
+        area += at;
+        sx += at*(double(a.x)+b.x+c.x)/3;
+        sy += at*(double(a.y)+b.y+c.y)/3;
+    }
+    if (area > 0)
+        centroid = Point{int(lround(sx/area)),int(lround(sy/area))};
+}
+
+// q inside the polygon or on its border: only the
+// triangles binned into the cell of q are tested
+bool Triangulation::contains(Point q) const
+{
+    if ( indices.empty() || (q.x < tl.x) || (q.y < tl.y) )
+        return false;
+    size_t x = size_t((q.x-tl.x)/cell), y = size_t((q.y-tl.y)/cell);
+    if ( (x >= cols) || (y >= rows) )
+        return false;
+    size_t c = y*cols+x;
+    for (size_t k=first[c]; k < first[c+1]; k++)
+    {
+        const uint32_t* t = &indices[3*size_t(cells[k])];
+        long long d1 = cross(pts[t[0]],pts[t[1]],q);
+        long long d2 = cross(pts[t[1]],pts[t[2]],q);
+        long long d3 = cross(pts[t[2]],pts[t[0]],q);
+        // on the same side of the three edges, or on one of them
+        bool neg = (d1 < 0) || (d2 < 0) || (d3 < 0);
+        bool pos = (d1 > 0) || (d2 > 0) || (d3 > 0);
+        if ( !(neg && pos) )
+            return true;
+    }
+    return false;
+}
+
+// ear clipping: a convex corner is an ear when no other vertex
+// lies in its triangle, it is cut off and the walk goes on with
+// the next corner; the vertices are looked up in the grid
+void Triangulation::clip_ears(size_t n)
+{
+    const Point* p = pts;
+    
+    // orientation of the polygon, nothing to do if flat
+    long long s = 0;
+    for (size_t i=0; i < n; i++)
+        s += (long long)p[i].x*p[(i+1) % n].y - (long long)p[(i+1) % n].x*p[i].y;
+    if (s == 0)
+        return;
+    long long sign = (s > 0) ? 1 : -1;
+    
+    // the vertices left, as a circular list
+    vector<uint32_t> prev(n), next(n);
+    vector<bool> gone(n,false);
+    for (size_t i=0; i < n; i++)
+    {
+        prev[i] = uint32_t((i+n-1) % n);
+        next[i] = uint32_t((i+1) % n);
+    }
+    
+    // vertices of each cell, stored one cell after the other
+    auto cell_x = [this](int x) { return size_t((x-tl.x)/cell); };
+    auto cell_y = [this](int y) { return size_t((y-tl.y)/cell); };
+    vector<uint32_t> vfirst(cols*rows+1,0);
+    vector<uint32_t> vcells(n);
+    for (size_t i=0; i < n; i++)
+        vfirst[cell_y(p[i].y)*cols+cell_x(p[i].x)+1]++;
+    for (size_t c=1; c < vfirst.size(); c++)
+        vfirst[c] += vfirst[c-1];
+    vector<uint32_t> fill_at(vfirst.begin(),vfirst.end()-1);
+    for (size_t i=0; i < n; i++)
+        vcells[fill_at[cell_y(p[i].y)*cols+cell_x(p[i].x)]++] = uint32_t(i);
+    
+    // some vertex left lies in the triangle a,b,c or on its border
+    auto blocked = [&](uint32_t a, uint32_t b, uint32_t c) {
+        Point A = p[a], B = p[b], C = p[c];
+        bool found = false;
+        for_each_cell(A,B,C,[&](size_t cl) {
+            for (size_t k=vfirst[cl]; !found && (k < vfirst[cl+1]); k++)
+            {
+                uint32_t v = vcells[k];
+                if ( gone[v] || (v == a) || (v == b) || (v == c) )
+                    continue;
+                Point V = p[v];
+                found = (sign*cross(A,B,V) >= 0) && (sign*cross(B,C,V) >= 0) &&
+                        (sign*cross(C,A,V) >= 0);
+            }
+        });
+        return found;
+    };
+    
+    indices.reserve(3*(n-2));
+    size_t left = n;
+    uint32_t ear = 0, stop = 0;
+    bool forced = false;
+    while (left > 3)
+    {
+        uint32_t a = prev[ear], c = next[ear];
+        long long t = sign*cross(p[a],p[ear],p[c]);
+        // a flat corner is dropped without a triangle; a full turn
+        // without any ear only happens with degenerate polygons,
+        // the next corner is then cut off anyway
+        if ( (t == 0) || forced || ((t > 0) && !blocked(a,ear,c)) )
+        {
+            if (t != 0)
+                indices.insert(indices.end(),{a,ear,c});
+            next[a] = c;
+            prev[c] = a;
+            gone[ear] = true;
+            left--;
+            // skipping a corner cuts the polygon down evenly instead
+            // of as a fan of long triangles around one vertex
+            ear = stop = next[c];
+            forced = false;
+        } else
+        {
+            ear = c;
+            if (ear == stop)
+                forced = true;
+        }
+    }
+    uint32_t a = prev[ear], c = next[ear];
+    if (cross(p[a],p[ear],p[c]) != 0)
+        indices.insert(indices.end(),{a,ear,c});
+}
+
+// bin the triangles into the cells they overlap
+void Triangulation::bin_triangles()
+{
+    const Point* p = pts;
+    size_t nt = indices.size()/3;
+    first.assign(cols*rows+1,0);
+    for (size_t t=0; t < nt; t++)
+        for_each_cell(p[indices[3*t]],p[indices[3*t+1]],p[indices[3*t+2]],
+                      [this](size_t c) { first[c+1]++; });
+    for (size_t c=1; c < first.size(); c++)
+        first[c] += first[c-1];
+    cells.resize(first.back());
+    vector<uint32_t> fill_at(first.begin(),first.end()-1);
+    for (size_t t=0; t < nt; t++)
+        for_each_cell(p[indices[3*t]],p[indices[3*t+1]],p[indices[3*t+2]],
+                      [&](size_t c) { cells[fill_at[c]++] = uint32_t(t); });
+}
+
+} // namespace mathsophy::graphics
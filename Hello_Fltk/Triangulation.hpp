@@ -0,0 +1,92 @@
+/*
+    Hello_Fltk Xcode project
+
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    Triangulation.hpp
+    Hello_Fltk
+
+    Created by agent on 19.10.26.
+*/
+
+
+#ifndef Triangulation_hpp
+#define Triangulation_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Graphics.hpp"
+
+namespace mathsophy::graphics
+{
+
+using namespace std;
+
+//
+// Triangulation
+//
+
+// the inside of a simple polygon as triangles, found by ear
+// clipping: the vertices are binned into a grid so that an ear
+// is only tested against the vertices near it; the triangles
+// are binned as well, which turns contains() into a lookup
+class Triangulation
+{
+public:
+    // constructor, p[0..n) are the vertices of the polygon
+    Triangulation(const Point* p, size_t n);
+    // no copy constructor allowed
+    Triangulation(const Triangulation&) = delete;
+    // no copy assignment allowed
+    Triangulation& operator=(const Triangulation&) = delete;
+    // virtual destructor
+    virtual ~Triangulation() {}
+    // getter methods: three vertex indices per triangle
+    const vector<uint32_t>& get_indices() const { return indices; }
+    size_t get_nb_triangles() const { return indices.size()/3; }
+    double get_area() const         { return area; }
+    Point  get_centroid() const     { return centroid; }
+    // q inside the polygon or on its border
+    bool contains(Point q) const;
+private:
+    const Point* pts;           // vertices of the polygon, which drops
+                                // the triangulation when they change
+    vector<uint32_t> indices;   // triangles as index triples
+    double area{0};             // area of the inside
+    Point centroid;             // center of mass of the inside
+    // grid of the triangles
+    Point tl;                   // top-left corner of the grid
+    double cell{1};             // size of a cell
+    size_t cols{0}, rows{0};    // number of cells
+    vector<uint32_t> first;     // triangles of cell c are in
+    vector<uint32_t> cells;     // cells[first[c]..first[c+1])
+    // helper methods
+    void clip_ears(size_t n);
+    void bin_triangles();
+    template<class F> void for_each_cell(Point a, Point b, Point c, F f) const;
+};
+
+}
+#endif /* Triangulation_hpp */
@@ -0,0 +1,1124 @@
+/*
+    Hello_Fltk Xcode project
+ 
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    benchmarks.cpp
+    Hello_Fltk
+  
+    Created by agent on 19.10.26.
+*/
+
+#include "Graphics.hpp"
+#include "Image_cache.hpp"
+#include "Image_scaler.hpp"
+#include "Raster.hpp"
+#include "Scene.hpp"
+#include "Span_kernels.hpp"
+
+using namespace mathsophy::graphics;
+
+#include "benchmarks.h"
+#include "example_scenes.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+namespace
+{
+
+// best time in seconds of one call of f: f is repeated until
+// a sample lasts at least 10 ms, the best of 5 samples is kept
+double best_time(const function<void()>& f)
+{
+    using clock = chrono::steady_clock;
+    size_t reps = 1;
+    double best = 0;
+    for (int sample=0; sample < 5; )
+    {
+        auto start = clock::now();
+        for (size_t i=0; i < reps; i++) f();
+        double t = chrono::duration<double>(clock::now()-start).count();
+        if (t < 0.01)
+        {
+            reps *= 2;
+            continue;
+        }
+        if ( (sample == 0) || (t/reps < best) )
+            best = t/reps;
+        sample++;
+    }
+    return best;
+}
+
+// one result of a benchmark
+struct Result
+{
+    string suite, name, variant;
+    size_t n;
+    double value;
+    string unit;
+    // identifies the same measurement across runs
+    string key() const {
+        return suite + '\t' + name + '\t' + variant + '\t' + to_string(n) + '\t' + unit;
+    }
+};
+
+// results are printed, or collected when this is set
+vector<Result>* collected = nullptr;
+
+void report(const string& suite, const string& name, const string& variant,
+            size_t n, double value, const string& unit)
+{
+    if (collected)
+    {
+        collected->push_back(Result{suite,name,variant,n,value,unit});
+        return;
+    }
+    cout << suite << '\t' << name << '\t' << variant << '\t'
+         << n << '\t' << value << '\t' << unit << endl;
+}
+
+// comment line among the results
+void note(const string& s)
+{
+    if (!collected)
+        cout << "# " << s << endl;
+}
+
+// the kernels available on this CPU, scalar first
+vector<const Span_kernels*> supported_kernels()
+{
+    vector<const Span_kernels*> v;
+    for (Kernel_type t : {Kernel_type::scalar,Kernel_type::sse2,Kernel_type::avx2,Kernel_type::neon})
+        if (kernel_supported(t))
+            v.push_back(&span_kernels(t));
+    return v;
+}
+
+//
+// Span kernels suite
+//
+
+// throughput of the fill and column kernels and of filled
+// rectangles on a raster, every SIMD kernel is checked against
+// the scalar one and reported with its speedup
+void kernels_suite()
+{
+    const Pixel p = pack_pixel(10,20,30);
+    vector<const Span_kernels*> kernels = supported_kernels();
+    
+    // horizontal spans, starting one pixel off the
+    // alignment to exercise the unaligned head
+    for (size_t n : {16,64,256,1024,4096,65536})
+    {
+        vector<Pixel> ref(n+1,0), buf(n+1,0);
+        kernels[0]->fill(ref.data()+1,n,p);
+        double scalar = 0;
+        for (auto k : kernels)
+        {
+            fill(buf.begin(),buf.end(),0);
+            k->fill(buf.data()+1,n,p);
+            if (buf != ref)
+                throw runtime_error(string{"kernels_suite(): "} + k->name + " fill differs from scalar!");
+            double t = best_time([&] { k->fill(buf.data()+1,n,p); });
+            if (k->type == Kernel_type::scalar) scalar = t;
+            report("kernels","fill",k->name,n,n/t*1e-6,"Mpix/s");
+            report("kernels","fill",k->name,n,scalar/t,"speedup");
+        }
+    }
+    
+    // vertical lines on a 1024 pixels wide canvas
+    for (size_t n : {64,256,1024})
+    {
+        const ptrdiff_t stride = 1024;
+        vector<Pixel> buf(n*stride,0);
+        double scalar = 0;
+        for (auto k : kernels)
+        {
+            double t = best_time([&] { k->column(buf.data()+1,n,stride,p); });
+            if (k->type == Kernel_type::scalar) scalar = t;
+            report("kernels","column",k->name,n,n/t*1e-6,"Mpix/s");
+            report("kernels","column",k->name,n,scalar/t,"speedup");
+        }
+    }
+    
+    // filled squares through the whole raster path
+    for (int n : {8,64,512})
+    {
+        Canvas c{1024,1024};
+        double scalar = 0;
+        for (auto k : kernels)
+        {
+            Raster r{c,*k};
+            r.color(FL_RED);
+            double t = best_time([&] { r.rectf(1,1,n,n); });
+            if (k->type == Kernel_type::scalar) scalar = t;
+            report("kernels","rectf",k->name,size_t(n)*n,double(n)*n/t*1e-6,"Mpix/s");
+            report("kernels","rectf",k->name,size_t(n)*n,scalar/t,"speedup");
+        }
+    }
+}
+
+//
+// Anti-aliased lines suite
+//
+
+// coverage blending kernels against the scalar one, then a trace
+// of 1M short segments drawn aliased and anti-aliased: the
+// slowdown of the anti-aliased mode is reported
+void lines_suite()
+{
+    const Pixel p = pack_pixel(200,30,60);
+    vector<const Span_kernels*> kernels = supported_kernels();
+    
+    for (size_t n : {16,256,4096})
+    {
+        vector<uchar> cov(n);
+        for (size_t i=0; i < n; i++) cov[i] = uchar(i*37);
+        vector<Pixel> ref(n+1), buf(n+1);
+        for (size_t i=0; i <= n; i++) ref[i] = Pixel(i*2654435761u);
+        vector<Pixel> start = ref;
+        kernels[0]->blend(ref.data()+1,cov.data(),n,p);
+        double scalar = 0;
+        for (auto k : kernels)
+        {
+            buf = start;
+            k->blend(buf.data()+1,cov.data(),n,p);
+            if (buf != ref)
+                throw runtime_error(string{"lines_suite(): "} + k->name + " blend differs from scalar!");
+            double t = best_time([&] { k->blend(buf.data()+1,cov.data(),n,p); });
+            if (k->type == Kernel_type::scalar) scalar = t;
+            report("lines","blend",k->name,n,n/t*1e-6,"Mpix/s");
+            report("lines","blend",k->name,n,scalar/t,"speedup");
+        }
+    }
+    
+    // a wavy trace folded over a 2000x1000 canvas
+    const size_t nb_segments = 1000000;
+    vector<Point> trace;
+    for (size_t i=0; i <= nb_segments; i++)
+        trace.push_back(Point{int(i*7 % 1993),int(500+450*sin(i*0.013))});
+    Canvas c{2000,1000};
+    double aliased = 0;
+    for (bool aa : {false,true})
+    {
+        Raster r{c};
+        r.antialias(aa);
+        r.color(FL_BLUE);
+        double t = best_time([&] {
+            for (size_t i=0; i < nb_segments; i++)
+                r.line(trace[i].x,trace[i].y,trace[i+1].x,trace[i+1].y);
+        });
+        if (!aa) aliased = t;
+        const char* variant = aa ? "antialiased" : "aliased";
+        report("lines","trace",variant,nb_segments,nb_segments/t*1e-6,"Mseg/s");
+        report("lines","trace",variant,nb_segments,t/aliased,"slowdown");
+    }
+}
+
+//
+// Alpha suite
+//
+
+// premultiplied compositing kernel against the scalar one, then
+// overlapping rectangles drawn opaque and half transparent
+void alpha_suite()
+{
+    vector<const Span_kernels*> kernels = supported_kernels();
+    
+    for (size_t n : {16,256,4096})
+    {
+        vector<Pixel> src(n), start(n+1);
+        for (size_t i=0; i < n; i++)
+            src[i] = premultiply(Pixel(i*2654435761u) | 0xff000000,unsigned(i*37) & 255);
+        for (size_t i=0; i <= n; i++)
+            start[i] = Pixel(i*40503u) | 0xff000000;
+        for (unsigned a : {255u,100u})
+        {
+            vector<Pixel> ref = start;
+            kernels[0]->over(ref.data()+1,src.data(),n,a);
+            double scalar = 0;
+            for (auto k : kernels)
+            {
+                vector<Pixel> buf = start;
+                k->over(buf.data()+1,src.data(),n,a);
+                if (buf != ref)
+                    throw runtime_error(string{"alpha_suite(): "} + k->name + " over differs from scalar!");
+                double t = best_time([&] { k->over(buf.data()+1,src.data(),n,a); });
+                if (k->type == Kernel_type::scalar) scalar = t;
+                string name = (a == 255) ? "over" : "over_opacity";
+                report("alpha",name,k->name,n,n/t*1e-6,"Mpix/s");
+                report("alpha",name,k->name,n,scalar/t,"speedup");
+            }
+        }
+    }
+    
+    // 1000 overlapping 200x200 rectangles on a 1000x1000
+    // canvas, every translucent one in its own layer
+    Canvas c{1000,1000};
+    double opaque = 0;
+    for (bool translucent : {false,true})
+    {
+        Raster r{c};
+        double t = best_time([&] {
+            for (int i=0; i < 1000; i++)
+            {
+                int x = (i*37) % 800, y = (i*91) % 800;
+                r.push_clip(x,y,200,200);
+                if (translucent) r.begin_layer();
+                r.color(Fl_Color(i % 256));
+                r.rectf(x,y,200,200);
+                if (translucent) r.end_layer(128);
+                r.pop_clip();
+            }
+        });
+        if (!translucent) opaque = t;
+        const char* variant = translucent ? "translucent" : "opaque";
+        report("alpha","rectangles",variant,1000,1000*200*200/t*1e-6,"Mpix/s");
+        report("alpha","rectangles",variant,1000,t/opaque,"slowdown");
+    }
+}
+
+//
+// Image scaling suite
+//
+
+// box and bilinear filters on a photo-sized RGB image,
+// throughput in source pixels per second
+void scale_suite()
+{
+    const int w = 4000, h = 3000, d = 3;
+    vector<uchar> src(size_t(w)*h*d);
+    for (size_t i=0; i < src.size(); i++)
+        src[i] = uchar(i*2654435761u >> 24);
+    for (int dw : {2000,640,100})
+    {
+        int dh = dw*h/w;
+        vector<uchar> dst(size_t(dw)*dh*d);
+        for (Scale_filter f : {Scale_filter::box,Scale_filter::bilinear})
+        {
+            double t = best_time([&] { scale_pixels(src.data(),w,h,d,0,dst.data(),dw,dh,f); });
+            const char* variant = (f == Scale_filter::box) ? "box" : "bilinear";
+            report("scale","4000x3000",variant,size_t(dw)*dh,double(w)*h/t*1e-6,"Mpix/s");
+        }
+    }
+    // zooming out step by step: every copy filtered from the full
+    // image, or from the nearest level of a mip pyramid built once
+    Fl_RGB_Image base{src.data(),w,h,d};
+    Mip_pyramid mips{&base};
+    mips.level_for(1,1);
+    for (bool pyramid : {false,true})
+    {
+        double t = best_time([&] {
+            for (int dw=1600; dw >= 100; dw -= 100)
+                delete (pyramid ? mips.scale(dw,dw*h/w) : scale_image(&base,dw,dw*h/w));
+        });
+        report("scale","zoom 1600..100",pyramid ? "mipmap" : "full",16,t/16*1e3,"ms/frame");
+    }
+}
+
+
+//
+// Geometry suite
+//
+
+// sizes of the geometry cases, from 10^2 to 10^6 elements
+const vector<size_t> geometry_sizes {100,1000,10000,100000,1000000};
+
+// runs a geometry case for growing sizes: make(n) builds the
+// data and returns the operation to time; the sizes stop growing
+// once the next one, extrapolated from the growth of the last
+// two, would take more than 10 seconds
+void geometry_case(const string& name, const string& variant,
+                   const function<function<void()>(size_t)>& make)
+{
+    using clock = chrono::steady_clock;
+    double last_make = 0, last_t = 0;
+    for (size_t n : geometry_sizes)
+    {
+        auto start = clock::now();
+        function<void()> f = make(n);
+        double t_make = chrono::duration<double>(clock::now()-start).count();
+        double t = best_time(f);
+        report("geometry",name,variant,n,t*1e3,"ms");
+        report("geometry",name,variant,n,t/n*1e9,"ns/elem");
+        // best_time() calls f at least 5 times
+        double next = t_make*max(10.0,last_make > 0 ? t_make/last_make : 0) +
+                      5*t*max(10.0,last_t > 0 ? t/last_t : 0);
+        if ( (next > 10.0) && (n != geometry_sizes.back()) )
+        {
+            note("geometry\t" + name + '\t' + variant + "\tsizes above " +
+                 to_string(n) + " skipped (over the time budget)");
+            break;
+        }
+        last_make = t_make;
+        last_t = t;
+    }
+}
+
+// a zigzag closed by a base below it: a simple polygon of n
+// points with small coordinates and no collinear sides
+vector<Point> zigzag_points(size_t n)
+{
+    vector<Point> v;
+    for (size_t i=0; i+2 < n; i++)
+        v.push_back(Point{int(i),1+int(i%2)});
+    v.push_back(Point{int(n-3),-10});
+    v.push_back(Point{0,-10});
+    return v;
+}
+
+// a star of n points alternating between two circles, the inner
+// one of half the radius: a simple polygon whose sides are long
+// and all cross the same area of the plane
+vector<Point> star_points(size_t n)
+{
+    vector<Point> v;
+    double r = 4.0*max(n,size_t(250));
+    for (size_t i=0; i < n; i++)
+    {
+        double a = 2*acos(-1.0)*i/n;
+        double d = (i % 2) ? r/2 : r;
+        v.push_back(Point{int(round(d*cos(a))),int(round(d*sin(a)))});
+    }
+    return v;
+}
+
+// construction of lines, polylines, functions and axes, the
+// intersection test, fill and triangulation of polygons, resize
+// and move of large shapes, each for 10^2 up to 10^6 elements
+void geometry_suite()
+{
+    // building shapes one element at a time
+    geometry_case("Lines::add_line","build",[](size_t n) {
+        return function<void()>{[n] {
+            Lines l;
+            for (size_t i=0; i < n; i++)
+                l.add_line({Point{int(i%1000),int(i/1000)},Point{int(i%1000)+5,int(i/1000)+5}});
+        }};
+    });
+    geometry_case("Open_polyline::add_point","build",[](size_t n) {
+        return function<void()>{[n] {
+            Open_polyline p;
+            for (size_t i=0; i < n; i++)
+                p.add_point(Point{int(i%1000),int(i*7%1000)});
+        }};
+    });
+    
+    // intersection test of simple polygons, no side crosses
+    // another one so that no pair ends the search early: short
+    // sides next to each other, and long sides around a center
+    for (bool star : {false,true})
+        geometry_case("Polygon::intersect",star ? "star" : "simple",[star](size_t n) {
+            auto p = make_shared<Polygon>();
+            for (auto& pnt : star ? star_points(n) : zigzag_points(n))
+                p->add_point(pnt);
+            if (p->intersect())
+                throw runtime_error("geometry_suite(): Polygon is not simple!");
+            return function<void()>{[p] { p->intersect(); }};
+        });
+    
+    // scanline fill of the same polygon into a strip of 1000 x 20
+    // pixels, after a change of the points and from the cache
+    for (bool cached : {false,true})
+        geometry_case("Polygon::render",cached ? "filled redraw" : "filled first",[cached](size_t n) {
+            auto p = make_shared<Polygon>();
+            for (auto& pnt : zigzag_points(n))
+                p->add_point(Point{pnt.x,pnt.y+12});
+            p->set_filled(true);
+            auto c = make_shared<Canvas>(1000,20);
+            auto r = make_shared<Raster>(*c);
+            return function<void()>{[p,c,r,cached] {
+                if (!cached)
+                    p->set_point(0,p->get_point(0));
+                p->render(*r);
+            }};
+        });
+    
+    // triangulation of the same polygon after a change of the
+    // points, then hit tests answered from the cached triangles
+    geometry_case("Closed_polyline::get_triangles","ear clipping",[](size_t n) {
+        auto p = make_shared<Closed_polyline>();
+        for (auto& pnt : zigzag_points(n))
+            p->add_point(pnt);
+        return function<void()>{[p] {
+            p->set_point(0,p->get_point(0));
+            p->get_triangles();
+        }};
+    });
+    geometry_case("Closed_polyline::contains","1000 points",[](size_t n) {
+        auto p = make_shared<Closed_polyline>();
+        for (auto& pnt : zigzag_points(n))
+            p->add_point(pnt);
+        p->get_triangles();
+        return function<void()>{[p,n] {
+            for (size_t i=0; i < 1000; i++)
+                p->contains(Point{int(i*(n-3)/1000),-5});
+        }};
+    });
+    
+    // scatter of n filled circles of radius 2 over a canvas of
+    // 1000 x 1000 pixels, all visible and clipped to one corner
+    for (bool culled : {false,true})
+        geometry_case("Circles::render",culled ? "100 x 100 view" : "scatter",[culled](size_t n) {
+            auto p = make_shared<Circles>();
+            p->reserve(n);
+            mt19937 gen{42};
+            uniform_int_distribution<int> d{0,999};
+            for (size_t i=0; i < n; i++)
+                p->add_circle(Point{d(gen),d(gen)},2);
+            p->set_filled(true);
+            auto c = make_shared<Canvas>(culled ? 100 : 1000,culled ? 100 : 1000);
+            auto r = make_shared<Raster>(*c);
+            p->render(*r);
+            return function<void()>{[p,c,r] { p->render(*r); }};
+        });
+
+    // functions sampled over [-10,10) with n steps
+    geometry_case("Function","step 20/n",[](size_t n) {
+        return function<void()>{[n] {
+            Function f{[](double x) { return sin(x); },{-10,10},20.0/n,{-1,1},Point{500,500},1000};
+        }};
+    });
+    
+    // axes with n notches
+    geometry_case("XAxis","notches",[](size_t n) {
+        return function<void()>{[n] {
+            XAxis a{{0,double(n)},1,Point{0,500},1000};
+        }};
+    });
+    geometry_case("YAxis","notches",[](size_t n) {
+        return function<void()>{[n] {
+            YAxis a{{0,double(n)},1,Point{500,1000},1000};
+        }};
+    });
+    
+    // editing one point resizes the whole marked polyline,
+    // with one marker for all the points or one each
+    for (bool each : {false,true})
+        geometry_case("Marked_polyline::resize_widget",each ? "marker each" : "same marker",[each](size_t n) {
+            vector<string> marks{"x"};
+            if (each)
+            {
+                marks.clear();
+                for (size_t i=0; i < n; i++)
+                    marks.push_back(to_string(i%100));
+            }
+            auto p = make_shared<Marked_polyline>(marks);
+            for (size_t i=0; i < n; i++)
+                p->add_point(Point{int(i%1000),int(i*7%1000)});
+            return function<void()>{[p] { p->set_point(0,p->get_point(0)); }};
+        });
+    
+    // moving large shapes back and forth
+    geometry_case("move","Open_polyline",[](size_t n) {
+        auto p = make_shared<Open_polyline>();
+        for (size_t i=0; i < n; i++)
+            p->add_point(Point{int(i%1000),int(i*7%1000)});
+        return function<void()>{[p] { p->move(1,1); p->move(-1,-1); }};
+    });
+    geometry_case("move","Lines",[](size_t n) {
+        auto l = make_shared<Lines>();
+        for (size_t i=0; i < n; i++)
+            l->add_line({Point{int(i%1000),int(i/1000)},Point{int(i%1000)+5,int(i/1000)+5}});
+        return function<void()>{[l] { l->move(1,1); l->move(-1,-1); }};
+    });
+}
+
+//
+// Scenes suite
+//
+
+// peak resident memory of the process in bytes; on Linux the
+// peak can be reset, elsewhere it only grows from scene to scene
+size_t peak_rss()
+{
+#ifdef __linux__
+    ifstream status{"/proc/self/status"};
+    string line;
+    while (getline(status,line))
+        if (line.compare(0,6,"VmHWM:") == 0)
+            return size_t(stoull(line.substr(6)))*1024;
+#endif
+    rusage u;
+    getrusage(RUSAGE_SELF,&u);
+#ifdef __APPLE__
+    return size_t(u.ru_maxrss);
+#else
+    return size_t(u.ru_maxrss)*1024;
+#endif
+}
+
+void reset_peak_rss()
+{
+#ifdef __linux__
+    ofstream{"/proc/self/clear_refs"} << "5";
+#endif
+}
+
+// a scene of the examples and the size of its window
+struct Example_scene
+{
+    string name;
+    int w, h;
+    Scene_builder build;
+};
+
+// the scenes of examples.cpp as they look when the window
+// appears, plus scaled up variants; the images need their
+// files in the working directory and are skipped otherwise
+vector<Example_scene> example_scenes()
+{
+    vector<Example_scene> v;
+    v.push_back({"lines",640,480,lines_scene});
+    // the grid of the example has 80x40 cells, the scaled
+    // up variant one line for every pixel
+    v.push_back({"grid",640,480,[](Scene& s) { grid_scene(s); }});
+    v.push_back({"grid 1px",640,480,[](Scene& s) { grid_scene(s,1,1,1); }});
+    v.push_back({"polylines",640,480,polylines_scene});
+    v.push_back({"rectangles",640,480,rectangles_scene});
+    // 16x16 cells of 20 pixels as in the example,
+    // 256x256 cells of 2 pixels in the scaled up variant
+    v.push_back({"16x16 colorgrid",640,480,[](Scene& s) { colorgrid_scene(s); }});
+    v.push_back({"256x256 colorgrid",512,512,[](Scene& s) { colorgrid_scene(s,256,2); }});
+    v.push_back({"text",640,480,text_scene});
+    v.push_back({"circles",640,480,circles_scene});
+    v.push_back({"ellipses",640,480,ellipses_scene});
+    v.push_back({"markedpolylines",640,480,markedpolylines_scene});
+    v.push_back({"marks",640,480,marks_scene});
+    v.push_back({"circleswithmarks",640,480,circleswithmarks_scene});
+    if ( filesystem::exists("MilkyWay.jpg") && filesystem::exists("Moon.jpg") )
+        v.push_back({"images",640,480,[](Scene& s) { images_scene(s); }});
+    v.push_back({"functions",640,480,functions_scene});
+    // the last approximation of the example
+    v.push_back({"exponentials",640,480,[](Scene& s) {
+        exponentials_scene(s);
+        exponential_approx_scene(s,9);
+    }});
+    v.push_back({"dataplots",640,480,dataplots_scene});
+    return v;
+}
+
+// the main lines of the axes must be in the canvas, on one
+// thread and in tiles, halfway between the first two notches
+void check_axes(Thread_pool& pool)
+{
+    Scene scene{200,200};
+    XAxis& xaxis = scene.add(new XAxis{{0,10},1,Point{20,180},160});
+    xaxis.set_color(Color_type::red);
+    YAxis& yaxis = scene.add(new YAxis{{0,10},1,Point{20,180},160});
+    yaxis.set_color(Color_type::blue);
+    int x = (xaxis.pos(0)+xaxis.pos(1))/2;
+    int y = (yaxis.pos(0)+yaxis.pos(1))/2;
+    Canvas c{scene.w(),scene.h()};
+    for (bool tiles : {false,true})
+    {
+        if (tiles) scene.render(c,pool,64);
+        else scene.render(c);
+        if ( (c.row(xaxis.get_orig().y)[x] != to_pixel(to_fl_color(Color_type::red))) ||
+             (c.row(y)[yaxis.get_orig().x] != to_pixel(to_fl_color(Color_type::blue))) )
+            throw runtime_error("check_axes(): The axis lines are not rendered!");
+    }
+}
+
+// the built-in font of the raster is wider than the FLTK
+// text extents, the end of a string must not be cut off
+void check_text(Thread_pool& pool)
+{
+    Scene scene{500,100};
+    string s(39,'M');
+    Text& text = scene.add(new Text{Point{10,50},s});
+    text.set_font(Font_type::times_bold_italic,18);
+    text.set_color(Color_type::red);
+    // square cell of the last glyph
+    int k = Raster::text_height(18)/5;
+    int x0 = 10+Raster::text_width(s,18)-4*k;
+    Canvas c{scene.w(),scene.h()};
+    for (bool tiles : {false,true})
+    {
+        if (tiles) scene.render(c,pool,64);
+        else scene.render(c);
+        bool drawn = false;
+        for (int y=50-5*k; y < 50; y++)
+            for (int x=x0; x < x0+3*k; x++)
+                if (c.row(y)[x] == to_pixel(to_fl_color(Color_type::red)))
+                    drawn = true;
+        if (!drawn)
+            throw runtime_error("check_text(): The end of the text is not rendered!");
+    }
+}
+
+// every scene is built once and rendered offscreen for a fixed
+// number of frames, on one thread and in tiles on all the cores:
+// frames per second, latency percentiles of the frames and the
+// peak resident memory while the scene exists
+void scenes_suite()
+{
+    const size_t nb_frames = 100;
+    Thread_pool pool;
+    check_axes(pool);
+    check_text(pool);
+    for (auto& sc : example_scenes())
+    {
+        reset_peak_rss();
+        auto start = chrono::steady_clock::now();
+        Scene scene{sc.w,sc.h};
+        sc.build(scene);
+        double t_build = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        report("scenes",sc.name,"build",scene.get_nb_shapes(),t_build*1e3,"ms");
+        Canvas c{scene.w(),scene.h()};
+        for (bool tiles : {false,true})
+        {
+            const char* variant = tiles ? "tiles" : "single";
+            vector<double> frames;
+            for (size_t i=0; i < nb_frames; i++)
+            {
+                auto t0 = chrono::steady_clock::now();
+                if (tiles) scene.render(c,pool);
+                else scene.render(c);
+                frames.push_back(chrono::duration<double>(chrono::steady_clock::now()-t0).count());
+            }
+            double total = 0;
+            for (double f : frames) total += f;
+            sort(frames.begin(),frames.end());
+            auto percentile = [&](double p) { return frames[min(frames.size()-1,size_t(p*frames.size()))]; };
+            report("scenes",sc.name,variant,nb_frames,nb_frames/total,"fps");
+            report("scenes",sc.name,variant,nb_frames,percentile(0.50)*1e3,"p50 ms");
+            report("scenes",sc.name,variant,nb_frames,percentile(0.90)*1e3,"p90 ms");
+            report("scenes",sc.name,variant,nb_frames,percentile(0.99)*1e3,"p99 ms");
+            report("scenes",sc.name,variant,nb_frames,frames.back()*1e3,"max ms");
+        }
+        report("scenes",sc.name,"peak rss",scene.get_nb_shapes(),peak_rss()/1048576.0,"MiB");
+    }
+}
+
+//
+// Allocations suite
+//
+
+// heap allocations and time of the exponentials() example: the
+// function and the axes built once, then the loop building and
+// destroying the 10 approximations, 16001 samples each
+void alloc_suite()
+{
+    size_t allocs = nb_allocations();
+    auto start = chrono::steady_clock::now();
+    {
+        Scene scene{640,480};
+        exponentials_scene(scene);
+        report("alloc","exponentials","scene",3,double(nb_allocations()-allocs),"allocs");
+        
+        allocs = nb_allocations();
+        auto loop = chrono::steady_clock::now();
+        for (int n=0; n < 10; n++)
+        {
+            Scene approx{640,480};
+            exponential_approx_scene(approx,n);
+        }
+        double t = chrono::duration<double>(chrono::steady_clock::now()-loop).count();
+        report("alloc","exponentials","rebuild loop",10,double(nb_allocations()-allocs),"allocs");
+        report("alloc","exponentials","rebuild loop",10,t*1e3,"ms");
+    }
+    double t = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    report("alloc","exponentials","total",13,t*1e3,"ms");
+    
+    // a large grid of lines and a long polyline built and destroyed
+    allocs = nb_allocations();
+    {
+        Lines grid;
+        for (int x=0; x < 1000; x++)
+            grid.add_line({Point{x,0},Point{x,1000}});
+        Open_polyline trace;
+        for (int x=0; x < 1000; x++)
+            trace.add_point(Point{x,500+int(400*sin(x*0.01))});
+    }
+    report("alloc","lines+polyline","build",2000,double(nb_allocations()-allocs),"allocs");
+}
+
+//
+// Startup suite
+//
+
+// time to get a photo sized image from the image cache when
+// it is not resident: decoded from the file, or mapped from
+// the disk cache filled by an earlier run
+void startup_suite()
+{
+    filesystem::path dir = filesystem::temp_directory_path() / "hello_fltk_startup";
+    filesystem::create_directories(dir);
+    string fn = (dir / "startup.png").string();
+    const int w = 3000, h = 2000;
+    Canvas c{w,h};
+    for (int y=0; y < h; y++)
+    {
+        Pixel* p = c.row(y);
+        for (int x=0; x < w; x++)
+            p[x] = pack_pixel(uchar(x*255/w),uchar(y*255/h),uchar((x^y)*2654435761u >> 24));
+    }
+    c.write_png(fn);
+    
+    Image_cache& cache = Image_cache::instance();
+    string old_dir = cache.get_disk_cache();
+    for (bool disk : {false,true})
+    {
+        cache.set_disk_cache(disk ? (dir / "decoded").string() : string{});
+        // the first run writes the disk cache
+        cache.release(cache.get(fn));
+        cache.clear();
+        double t = best_time([&] {
+            cache.release(cache.get(fn));
+            cache.clear();
+        });
+        report("startup","3000x2000 png",disk ? "disk cache" : "decode",size_t(w)*h,t*1e3,"ms");
+    }
+    cache.set_disk_cache(old_dir);
+    filesystem::remove_all(dir);
+}
+
+//
+// Regression gate
+//
+
+// a result over repeated runs: median and median absolute deviation
+struct Metric
+{
+    Result r;        // the result with its median as value
+    double mad{0};   // median absolute deviation of the runs
+    size_t runs{0};  // number of runs
+};
+
+double median(vector<double> v)
+{
+    if (v.empty()) return 0;
+    sort(v.begin(),v.end());
+    size_t m = v.size()/2;
+    return (v.size() % 2) ? v[m] : (v[m-1]+v[m])/2;
+}
+
+// the units of rates, all the others are times or sizes
+bool higher_is_better(const string& unit)
+{
+    return (unit == "fps") || (unit == "speedup") ||
+           (unit.size() > 2 && unit.compare(unit.size()-2,2,"/s") == 0);
+}
+
+// runs the suites the given number of times, the metrics are
+// sorted as the results of one run
+vector<Metric> measure(const vector< function<void()> >& suites, int runs)
+{
+    vector<string> order;
+    map< string, vector<double> > values;
+    map< string, Result > results;
+    for (int i=0; i < runs; i++)
+    {
+        cerr << "# run " << i+1 << " of " << runs << endl;
+        vector<Result> run;
+        collected = &run;
+        try {
+            for (auto& suite : suites) suite();
+        } catch (...) {
+            collected = nullptr;
+            throw;
+        }
+        collected = nullptr;
+        for (auto& r : run)
+        {
+            string k = r.key();
+            if (results.find(k) == results.end())
+            {
+                order.push_back(k);
+                results[k] = r;
+            }
+            values[k].push_back(r.value);
+        }
+    }
+    vector<Metric> metrics;
+    for (auto& k : order)
+    {
+        Metric m{results[k]};
+        m.r.value = median(values[k]);
+        vector<double> dev;
+        for (double v : values[k]) dev.push_back(fabs(v-m.r.value));
+        m.mad = median(dev);
+        m.runs = values[k].size();
+        metrics.push_back(m);
+    }
+    return metrics;
+}
+
+string json_string(const string& s)
+{
+    string j{"\""};
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\') j += '\\';
+        if (c == '\t') { j += "\\t"; continue; }
+        j += c;
+    }
+    return j + '"';
+}
+
+void write_baseline(const string& fn, const vector<Metric>& metrics)
+{
+    ofstream os{fn};
+    if (!os)
+        throw runtime_error("write_baseline(): Cannot open " + fn + "!");
+    os << setprecision(9) << "{\n  \"metrics\": [\n";
+    for (size_t i=0; i < metrics.size(); i++)
+    {
+        const Metric& m = metrics[i];
+        os << "    {\"suite\": " << json_string(m.r.suite)
+           << ", \"case\": " << json_string(m.r.name)
+           << ", \"variant\": " << json_string(m.r.variant)
+           << ", \"size\": " << m.r.n
+           << ", \"unit\": " << json_string(m.r.unit)
+           << ", \"median\": " << m.r.value
+           << ", \"mad\": " << m.mad
+           << ", \"runs\": " << m.runs << "}"
+           << ((i+1 < metrics.size()) ? ",\n" : "\n");
+    }
+    os << "  ]\n}\n";
+    if (!os)
+        throw runtime_error("write_baseline(): Cannot write " + fn + "!");
+}
+
+// reads the flat objects of the "metrics" array written by
+// write_baseline(), the other members are ignored
+vector<Metric> read_baseline(const string& fn)
+{
+    ifstream is{fn};
+    if (!is)
+        throw runtime_error("read_baseline(): Cannot open " + fn + "!");
+    string text{istreambuf_iterator<char>{is},istreambuf_iterator<char>{}};
+    size_t i = text.find("\"metrics\"");
+    if (i == string::npos || (i = text.find('[',i)) == string::npos)
+        throw runtime_error("read_baseline(): No metrics in " + fn + "!");
+    auto fail = [&fn] { return runtime_error("read_baseline(): Bad JSON in " + fn + "!"); };
+    auto skip = [&] { while (i < text.size() && isspace(uchar(text[i]))) i++; };
+    auto parse_string = [&] {
+        if (text[i] != '"') throw fail();
+        string v;
+        for (i++; i < text.size() && text[i] != '"'; i++)
+        {
+            if (text[i] == '\\' && ++i < text.size())
+                v += (text[i] == 't') ? '\t' : (text[i] == 'n') ? '\n' : text[i];
+            else v += text[i];
+        }
+        if (i++ >= text.size()) throw fail();
+        return v;
+    };
+    vector<Metric> metrics;
+    for (i++; ; )
+    {
+        skip();
+        if (i >= text.size()) throw fail();
+        if (text[i] == ']') break;
+        if (text[i] == ',') { i++; continue; }
+        if (text[i] != '{') throw fail();
+        map<string,string> members;
+        for (i++; ; )
+        {
+            skip();
+            if (i >= text.size()) throw fail();
+            if (text[i] == '}') { i++; break; }
+            if (text[i] == ',') { i++; continue; }
+            string name = parse_string();
+            skip();
+            if (i >= text.size() || text[i++] != ':') throw fail();
+            skip();
+            if (i < text.size() && text[i] == '"')
+                members[name] = parse_string();
+            else
+            {
+                size_t e = text.find_first_of(",}",i);
+                if (e == string::npos) throw fail();
+                members[name] = text.substr(i,e-i);
+                i = e;
+            }
+        }
+        try {
+            Metric m;
+            m.r = Result{members.at("suite"),members.at("case"),members.at("variant"),
+                         size_t(stoull(members.at("size"))),stod(members.at("median")),members.at("unit")};
+            m.mad = stod(members.at("mad"));
+            m.runs = size_t(stoull(members.at("runs")));
+            metrics.push_back(m);
+        } catch (logic_error&) {
+            throw fail();
+        }
+    }
+    return metrics;
+}
+
+// compares the metrics with the baseline: a metric regresses when
+// it got worse by more than the noise of the runs (3 scaled MADs,
+// 1.4826*MAD estimates the standard deviation) and by more than the
+// tolerance in percent; a metric of the baseline which was not
+// measured although its suite was run fails too, as the geometry
+// suite stops at the sizes which got too slow; returns the number
+// of failed metrics
+size_t compare(const vector<Metric>& baseline, const vector<Metric>& metrics,
+               const vector<string>& suites, double tolerance)
+{
+    map<string,const Metric*> base;
+    for (auto& m : baseline) base[m.r.key()] = &m;
+    size_t regressions = 0, improvements = 0, compared = 0;
+    cout << "status\tsuite\tcase\tvariant\tsize\tunit\tbaseline\tcurrent\tchange %\tthreshold %" << endl;
+    for (auto& m : metrics)
+    {
+        auto b = base.find(m.r.key());
+        if (b == base.end())
+            continue;
+        const Metric& old = *b->second;
+        base.erase(b);
+        compared++;
+        double ref = fabs(old.r.value);
+        double noise = 3*1.4826*max(old.mad,m.mad);
+        double threshold = max(noise,ref*tolerance/100);
+        double worse = higher_is_better(m.r.unit) ? old.r.value-m.r.value : m.r.value-old.r.value;
+        const char* status = "ok";
+        if (worse > threshold) { status = "REGRESSION"; regressions++; }
+        else if (-worse > threshold) { status = "improved"; improvements++; }
+        double change = (ref > 0) ? (m.r.value-old.r.value)/ref*100 : 0;
+        cout << status << '\t' << m.r.suite << '\t' << m.r.name << '\t' << m.r.variant << '\t'
+             << m.r.n << '\t' << m.r.unit << '\t' << old.r.value << '\t' << m.r.value << '\t'
+             << change << '\t' << ((ref > 0) ? threshold/ref*100 : 0) << endl;
+    }
+    size_t missing = 0, skipped = 0;
+    for (auto& old : baseline)
+    {
+        if (base.find(old.r.key()) == base.end())
+            continue;
+        if (find(suites.begin(),suites.end(),old.r.suite) == suites.end())
+        {
+            skipped++;
+            continue;
+        }
+        missing++;
+        cout << "MISSING\t" << old.r.suite << '\t' << old.r.name << '\t' << old.r.variant << '\t'
+             << old.r.n << '\t' << old.r.unit << '\t' << old.r.value << "\t\t\t" << endl;
+    }
+    cout << "# " << compared << " metrics compared: " << regressions << " regressed, "
+         << improvements << " improved, " << missing << " not measured, "
+         << skipped << " in suites not run" << endl;
+    return regressions + missing;
+}
+
+}
+
+// runs the benchmark suites named in argv (all of them if
+// none is given) and prints one result per line as tab
+// separated fields: suite, case, variant, size, value, unit;
+// with --save FILE the suites are run several times and the
+// median and spread of every result are stored as a JSON
+// baseline, with --check FILE they are compared to it instead
+// (--runs N repetitions, --tolerance PCT smallest change that
+// counts); returns the exit code of the program, 2 if a result
+// regressed or a result of the baseline was not measured
+int benchmarks(int argc, char **argv)
+{
+    const map< string, function<void()> > suites {
+        {"kernels",kernels_suite},
+        {"lines",lines_suite},
+        {"alloc",alloc_suite},
+        {"alpha",alpha_suite},
+        {"geometry",geometry_suite},
+        {"scale",scale_suite},
+        {"scenes",scenes_suite},
+        {"startup",startup_suite}
+    };
+    
+    string save, check;
+    int runs = 5;
+    double tolerance = 5;
+    vector<string> names;
+    for (int i=0; i < argc; i++)
+    {
+        string arg{argv[i]};
+        if ( (arg == "--save") && (i+1 < argc) )
+            save = argv[++i];
+        else if ( (arg == "--check") && (i+1 < argc) )
+            check = argv[++i];
+        else if ( (arg == "--runs") && (i+1 < argc) )
+            runs = max(1,atoi(argv[++i]));
+        else if ( (arg == "--tolerance") && (i+1 < argc) )
+            tolerance = max(0.0,atof(argv[++i]));
+        else if (arg.compare(0,2,"--") == 0)
+        {
+            cerr << "Unknown benchmark option: " << arg << endl;
+            return 1;
+        }
+        else names.push_back(arg);
+    }
+    if (names.empty())
+        for (auto& s : suites)
+            names.push_back(s.first);
+    
+    vector< function<void()> > selected;
+    for (auto& name : names)
+    {
+        auto s = suites.find(name);
+        if (s == suites.end())
+        {
+            cerr << "Unknown benchmark suite: " << name << endl;
+            return 1;
+        }
+        selected.push_back(s->second);
+    }
+    
+    if (save.empty() && check.empty())
+    {
+        cout << "# best span kernels: " << span_kernels().name << endl;
+        cout << "suite\tcase\tvariant\tsize\tvalue\tunit" << endl;
+        for (auto& suite : selected) suite();
+        return 0;
+    }
+    
+    // the baseline is read first, a bad file fails before the runs
+    vector<Metric> baseline;
+    if (!check.empty())
+        baseline = read_baseline(check);
+    vector<Metric> metrics = measure(selected,runs);
+    size_t regressions = 0;
+    if (!check.empty())
+        regressions = compare(baseline,metrics,names,tolerance);
+    if (!save.empty())
+    {
+        write_baseline(save,metrics);
+        cout << "# baseline of " << metrics.size() << " metrics written to " << save << endl;
+    }
+    return regressions ? 2 : 0;
+}
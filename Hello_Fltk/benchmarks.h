@@ -0,0 +1,52 @@
+/*
+    Hello_Fltk Xcode project
+ 
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    benchmarks.h
+    Hello_Fltk
+  
+    Created by agent on 19.10.26.
+*/
+
+#ifndef benchmarks_h
+#define benchmarks_h
+
+#include <cstddef>
+
+// runs the benchmark suites named in argv (all of them if
+// none is given) and prints one result per line as tab
+// separated fields: suite, case, variant, size, value, unit;
+// with --save FILE the suites are run several times and the
+// median and spread of every result are stored as a JSON
+// baseline, with --check FILE they are compared to it instead
+// (--runs N repetitions, --tolerance PCT smallest change that
+// counts); returns the exit code of the program, 2 if a result
+// regressed or a result of the baseline was not measured
+int benchmarks(int argc, char **argv);
+
+// calls of the global operator new so far, counted by
+// the benchmark target which replaces the operator
+size_t nb_allocations();
+
+#endif /* benchmarks_h */
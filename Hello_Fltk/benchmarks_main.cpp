@@ -0,0 +1,88 @@
+/*
+    Hello_Fltk Xcode project
+ 
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    benchmarks_main.cpp
+    Hello_Fltk
+  
+    Created by agent on 19.10.26.
+*/
+
+#include "benchmarks.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+
+// calls of the global operator new
+std::atomic<size_t> nb_allocs{0};
+
+}
+
+// the benchmark target replaces the global operator new
+// to count its calls for the alloc suite, the application
+// keeps the allocator of the standard library
+void* operator new(size_t size)
+{
+    nb_allocs.fetch_add(1,std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+size_t nb_allocations()
+{
+    return nb_allocs.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        // no windows, results on standard output
+        return benchmarks(argc-1,argv+1);
+    } catch (std::runtime_error& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...) {
+        std::cerr << "Other exception\n";
+        return 2;
+    }
+}
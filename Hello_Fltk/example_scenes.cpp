@@ -0,0 +1,319 @@
+/*
+    Hello_Fltk Xcode project
+ 
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    example_scenes.cpp
+    Hello_Fltk
+  
+    Created by agent on 19.10.26.
+*/
+
+#include "Graphics.hpp"
+#include "Scene.hpp"
+
+using namespace mathsophy::graphics;
+
+#include "example_scenes.h"
+
+#include <cmath>
+#include <memory>
+
+// factorial
+static double fact(int n) {
+    int r = 1;
+    while (n>1) {
+        r*=n;
+        --n;
+    }
+    return r;
+}
+
+// exponential function to the precision of n terms
+static double expe(double x, int n) {
+    double sum = 0;
+    for (int i=0; i<n; ++i) sum += pow(x,i)/fact(i);
+    return sum;
+}
+
+// Line and Lines classes
+void lines_scene(Scene& s)
+{
+    // a cross made of 2 lines
+    Line& horizontal = s.add(new Line{ {Point{100,300},Point{200,300}} });
+    horizontal.set_color(Color_type::blue);
+    horizontal.set_style(Style_type::solid, 2);
+    Line& vertical = s.add(new Line{ {Point{150,50},Point{150,150}} });
+    vertical.set_color(Color_type::blue);
+    vertical.set_style(Style_type::solid, 2);
+
+    Line& diagonal = s.add(new Line{ {Point{200,200},Point{250,250}} });
+    diagonal.set_color(Color_type::blue);
+    diagonal.set_style(Style_type::solid, 2);
+    
+    Lines& cross = s.add(new Lines);
+    cross.add_line( {Point{300,300},Point{400,300}} );
+    cross.add_line( {Point{350,250},Point{350,350}} );
+}
+
+// grid of Lines with cells of dx x dy pixels, dashed with width w
+void grid_scene(Scene& s, int dx, int dy, int w)
+{
+    Lines& grid = s.add(new Lines);
+    for (int x=dx; x<s.w(); x+=dx)
+        grid.add_line( {Point{x,0},Point{x,s.h()}} );
+    for (int y=dy; y<s.h(); y+=dy)
+        grid.add_line( {Point{0,y},Point{s.w(),y}} );
+    
+    grid.set_color(Color_type::red);
+    grid.set_style(Style_type::dash, w);
+}
+
+// polyline classes: Open_polyline, Closed_polyline, Polygon
+void polylines_scene(Scene& s)
+{
+    Open_polyline& open_poly = s.add(new Open_polyline{ Point{100,100}, Point{200,100},
+                                                        Point{150,50},  Point{150,150} });
+    open_poly.set_color(Color_type::magenta);
+    open_poly.set_style(Style_type::solid, 4);
+    
+    Closed_polyline& closed_poly = s.add(new Closed_polyline{ Point{300,300}, Point{400,300},
+                                                              Point{350,250}, Point{350,350} });
+    closed_poly.set_color(Color_type::green);
+    closed_poly.set_style(Style_type::solid, 4);
+    
+    Polygon& poly = s.add(new Polygon{ Point{200,150},Point{250,25},
+                                       Point{250,300}, Point{150,350} });
+    poly.set_color(Color_type::yellow);
+    poly.set_style(Style_type::solid, 4);
+}
+
+// five Rectangles, one of them not filled
+void rectangles_scene(Scene& s)
+{
+    s.add(new Rectangle{Point{150,100},200,100}).set_color(Color_type::yellow);
+    s.add(new Rectangle{Point{50,50},200,100}).set_color(Color_type::blue);
+    s.add(new Rectangle{Point{50,150},200,100}).set_color(Color_type::red);
+    s.add(new Rectangle{Point{250,50},200,100}).set_color(Color_type::green);
+    s.add(new Rectangle{Point{250,150},200,100}).set_filled(false);
+}
+
+// n x n color grid of Rectangles with cells of the given size
+void colorgrid_scene(Scene& s, int n, int cell)
+{
+    for (int i=0; i<n; ++i)
+        for (int j=0; j<n; ++j)
+            s.add(new Rectangle{Point{i*cell,j*cell},cell,cell}).set_color((i*n+j) % 256);
+}
+
+// Closed_polyline with a Text
+void text_scene(Scene& s)
+{
+    Closed_polyline& closed_poly = s.add(new Closed_polyline{ Point{300,300}, Point{400,300},
+                                                              Point{350,250}, Point{350,350} });
+    closed_poly.set_color(Color_type::green);
+    closed_poly.set_style(Style_type::solid, 4);
+    
+    Text& t = s.add(new Text{Point{200,200}," A closed polyline that isn't a polygon"});
+    t.set_font(Font_type::times_bold_italic,18);
+    t.set_color(Color_type::blue);
+}
+
+// Circle class
+void circles_scene(Scene& s)
+{
+    s.add(new Circle{Point{100,200},50});
+    s.add(new Circle{Point{150,200},100});
+    s.add(new Circle{Point{200,200},150});
+}
+
+// Ellipse class
+void ellipses_scene(Scene& s)
+{
+    s.add(new Ellipse{Point{200,200},50,50});
+    s.add(new Ellipse{Point{200,200},100,50});
+    s.add(new Ellipse{Point{200,200},100,150});
+}
+
+// Marked_polyline class
+void markedpolylines_scene(Scene& s)
+{
+    Marked_polyline& marked_poly = s.add(new Marked_polyline{ {"one","two","three","four"},
+        {Point{100,100},Point{200,100}, Point{150,50}, Point{150,150}} });
+    marked_poly.set_color(Color_type::magenta);
+    marked_poly.set_style(Style_type::solid, 2);
+    marked_poly.set_font(Font_type::times_bold_italic,12);
+    
+    Marked_polyline& marked_poly2 = s.add(new Marked_polyline{ {"{250,200}","{300,75}","{300,350}","{200,400}"} });
+    marked_poly2.add_point(Point{250,200});
+    marked_poly2.add_point(Point{300,75});
+    marked_poly2.add_point(Point{300,350});
+    marked_poly2.add_point(Point{200,400});
+    marked_poly2.set_color(Color_type::yellow);
+    marked_poly2.set_style(Style_type::solid, 4);
+    marked_poly2.set_font(Font_type::times_bold_italic,28);
+}
+
+// Marks class
+void marks_scene(Scene& s)
+{
+    Marks& marks = s.add(new Marks{"x",{Point{250,200},Point{300,75},Point{300,350},Point{200,400}}});
+    marks.set_color(Color_type::red);
+    marks.set_style(Style_type::solid, 4);
+    marks.set_font(Font_type::times_bold_italic,28);
+}
+
+// Circle and Mark classes
+void circleswithmarks_scene(Scene& s)
+{
+    s.add(new Circle{Point{100,200},50}).set_color(Color_type::blue);
+    s.add(new Circle{Point{150,200},100}).set_color(Color_type::red);
+    s.add(new Circle{Point{200,200},150}).set_color(Color_type::green);
+    
+    s.add(new Mark{Point{100,200},'x'});
+    s.add(new Mark{Point{150,200},'y'});
+    s.add(new Mark{Point{200,200},'z'});
+}
+
+// Image class, the files MilkyWay.jpg and Moon.jpg
+// must be in the working directory
+void images_scene(Scene& s, Load_type l)
+{
+    Image& milky_way = s.add(new Image{Point{0,0},"MilkyWay.jpg",l});
+    milky_way.use_mipmaps(true);
+    milky_way.scale(s.w(),s.h());
+    Image& moon = s.add(new Image{Point{0,0},"Moon.jpg"});
+    moon.set_mask(Point{350,350},300,300);
+}
+
+// Function, XAxis, and YAxis classes
+void functions_scene(Scene& s)
+{
+    // constant
+    Function& fg_1 = s.add(new Function{[](double){return 1;},{-2.0,2.0},0.001,{-2.0,2.0},
+        {320,240},200});
+    fg_1.add_label(-1.5,"1");
+    fg_1.set_color(Color_type::red);
+    
+    // line
+    Function& fg_2 = s.add(new Function{[](double x){return 2*x;},{-2.0,2.0},0.001,{-2.0,2.0},
+        {320,240},200});
+    fg_2.add_label(-1.0,"2x");
+    fg_2.set_color(Color_type::green);
+    
+    // parabola
+    Function& fg_3 = s.add(new Function{[](double x){return x*x;},{-2.0,2.0},0.001,{-2.0,2.0},
+        {320,240},200});
+    fg_3.add_label(-0.5,"x^2");
+    fg_3.set_color(Color_type::blue);
+    
+    // x axis
+    XAxis& xaxis = s.add(new XAxis{{-2.0,2.0},1,Point{320,240},200});
+    xaxis.add_label(1.0,"1");
+    xaxis.set_color(Color_type::magenta);
+    
+    // y-axis
+    YAxis& yaxis = s.add(new YAxis{{-2.0,2.0},1,Point{320,240},200});
+    yaxis.add_label(0,"O");
+    yaxis.add_label(1,"1");
+    yaxis.set_color(Color_type::magenta);
+}
+
+// exponential function with its axes
+void exponentials_scene(Scene& s)
+{
+    Function& e_gr = s.add(new Function{[](double x){return exp(x);},{-8.0,8.0},0.001,{-8.0,8.0},
+        {320,240},400});
+    e_gr.set_color(Color_type::red);
+    e_gr.add_label(2,"e^x");
+    
+    // x axis
+    XAxis& xaxis = s.add(new XAxis{{-8.0,8.0},1,Point{320,240},400});
+    xaxis.add_label(1.0,"1");
+    xaxis.set_color(Color_type::magenta);
+    
+    // y-axis
+    YAxis& yaxis = s.add(new YAxis{{-8.0,8.0},1,Point{320,240},400});
+    yaxis.add_label(0,"O");
+    yaxis.add_label(1,"1");
+    yaxis.set_color(Color_type::magenta);
+}
+
+// approximation of the exponential function by n terms
+void exponential_approx_scene(Scene& s, int n)
+{
+    s.add(new Function{[n](double x){return expe(x,n);},{-8.0,8.0},0.001,{-8.0,8.0},
+        {320,240},400});
+}
+
+// polylines representing data
+void dataplots_scene(Scene& s)
+{
+    // the axes place the data but are drawn last
+    unique_ptr<XAxis> xaxis{new XAxis{{2000,2009},1,Point{100,430},400}};
+    xaxis->add_label(2000,"2000",0,20);
+    xaxis->add_label(2005,"2005",0,20);
+    xaxis->add_label(2009,"2009",0,20);
+    xaxis->set_color(Color_type::black);
+    unique_ptr<YAxis> yaxis{new YAxis{{0,100},10,Point{100,430},400}};
+    yaxis->add_label(0,"0%",-40,0);
+    yaxis->add_label(50,"50%",-40,0);
+    yaxis->add_label(100,"100%",-40,0);
+    yaxis->set_color(Color_type::black);
+    
+    // axis titles
+    s.add(new Text{Point{120,470},"Years"});
+    s.add(new Text{Point{40,90},"Growth"});
+    
+    // titles of the data sets
+    s.add(new Text{Point{xaxis->pos(2001),yaxis->pos(78)-30},"Dataset 1"}).set_color(Color_type::red);
+    s.add(new Text{Point{xaxis->pos(2001),yaxis->pos(41)-50},"Dataset 2"}).set_color(Color_type::yellow);
+    s.add(new Text{Point{xaxis->pos(2001),yaxis->pos(22)-30},"Dataset 3"}).set_color(Color_type::blue);
+    
+    // data set 1
+    Open_polyline& poly1 = s.add(new Open_polyline);
+    vector<Point> ds_1 = {Point{2001,78}, Point{2002,70}, Point{2003,83},
+                          Point{2004,75}, Point{2005,70}, Point{2006,72},
+                          Point{2007,75}, Point{2008,77}, Point{2009,87} };
+    for (auto p:ds_1) poly1.add_point(Point{xaxis->pos(p.x),yaxis->pos(p.y)});
+    poly1.set_color(Color_type::red);
+    
+    // data set 2
+    Open_polyline& poly2 = s.add(new Open_polyline);
+    vector<Point> ds_2 = {Point{2001,41}, Point{2002,50}, Point{2003,38},
+                          Point{2004,51}, Point{2005,43}, Point{2006,52},
+                          Point{2007,33}, Point{2008,44}, Point{2009,61} };
+    for (auto p:ds_2) poly2.add_point(Point{xaxis->pos(p.x),yaxis->pos(p.y)});
+    poly2.set_color(Color_type::yellow);
+    
+    // data set 3
+    Open_polyline& poly3 = s.add(new Open_polyline);
+    vector<Point> ds_3 = {Point{2001,22}, Point{2002,14}, Point{2003,32},
+                          Point{2004,21}, Point{2005,23}, Point{2006,27},
+                          Point{2007,13}, Point{2008,20}, Point{2009,22} };
+    for (auto p:ds_3) poly3.add_point(Point{xaxis->pos(p.x),yaxis->pos(p.y)});
+    poly3.set_color(Color_type::blue);
+    
+    s.add(xaxis.release());
+    s.add(yaxis.release());
+}
@@ -0,0 +1,90 @@
+/*
+    Hello_Fltk Xcode project
+ 
+    This project is based on chapters 12 to 16 of Bjarne Stroustrup's book
+    "Programming - Principles and Practice Using C++", 2nd edition, Addison
+    Wesley, 2014. It is my own implementation of the graphics classes described
+    in the book, which I have coded while following along Bjarne's explanations from the
+    chapters above.
+
+    Copyright (C) 2022 Michele Iarossi - michele@mathsophy.com
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+    example_scenes.h
+    Hello_Fltk
+  
+    Created by agent on 19.10.26.
+*/
+
+#ifndef example_scenes_h
+#define example_scenes_h
+
+#include "Scene.hpp"
+
+// the shapes of the examples built into a scene: the windows
+// of examples.cpp show them, the benchmarks render them offscreen
+
+// Line and Lines classes
+void lines_scene(mathsophy::graphics::Scene& s);
+
+// grid of Lines with cells of dx x dy pixels, dashed with width w
+void grid_scene(mathsophy::graphics::Scene& s, int dx = 80, int dy = 40, int w = 4);
+
+// polyline classes: Open_polyline, Closed_polyline, Polygon
+void polylines_scene(mathsophy::graphics::Scene& s);
+
+// five Rectangles, one of them not filled
+void rectangles_scene(mathsophy::graphics::Scene& s);
+
+// n x n color grid of Rectangles with cells of the given size
+void colorgrid_scene(mathsophy::graphics::Scene& s, int n = 16, int cell = 20);
+
+// Closed_polyline with a Text
+void text_scene(mathsophy::graphics::Scene& s);
+
+// Circle class
+void circles_scene(mathsophy::graphics::Scene& s);
+
+// Ellipse class
+void ellipses_scene(mathsophy::graphics::Scene& s);
+
+// Marked_polyline class
+void markedpolylines_scene(mathsophy::graphics::Scene& s);
+
+// Marks class
+void marks_scene(mathsophy::graphics::Scene& s);
+
+// Circle and Mark classes
+void circleswithmarks_scene(mathsophy::graphics::Scene& s);
+
+// Image class, the files MilkyWay.jpg and Moon.jpg
+// must be in the working directory
+void images_scene(mathsophy::graphics::Scene& s,
+                  mathsophy::graphics::Load_type l = mathsophy::graphics::Load_type::synchronous);
+
+// Function, XAxis, and YAxis classes
+void functions_scene(mathsophy::graphics::Scene& s);
+
+// exponential function with its axes
+void exponentials_scene(mathsophy::graphics::Scene& s);
+
+// approximation of the exponential function by n terms
+void exponential_approx_scene(mathsophy::graphics::Scene& s, int n);
+
+// polylines representing data
+void dataplots_scene(mathsophy::graphics::Scene& s);
+
+#endif /* example_scenes_h */
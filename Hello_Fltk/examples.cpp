@@ -29,57 +29,35 @@
     Created by Michele Iarossi on 16.04.22.
 */
 
+#include "Animation.hpp"
 #include "Graphics.hpp"
+#include "Image_cache.hpp"
+#include "Mutation_queue.hpp"
+#include "Scene.hpp"
+#include "Tiled_image.hpp"
 
 using namespace mathsophy::graphics;
 
 #include "demoapp.hpp"
+#include "example_scenes.h"
 #include "examples.h"
 
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
 #include <sstream>
-
-// factorial
-static double fact(int n) {
-    int r = 1;
-    while (n>1) {
-        r*=n;
-        --n;
-    }
-    return r;
-}
-
-// exponential function to the precision of n terms
-static double expe(double x, int n) {
-    double sum = 0;
-    for (int i=0; i<n; ++i) sum += pow(x,i)/fact(i);
-    return sum;
-}
+#include <thread>
 
 // example usage of Line and Lines classes
 void lines()
 {
     Simple_window win(Point{100,100},640,480,"Lines");
-
-    // a cross made of 2 lines
-    Line horizontal{ {Point{100,300},Point{200,300}} };
-    horizontal.set_color(Color_type::blue);
-    horizontal.set_style(Style_type::solid, 2);
-    Line vertical{ {Point{150,50},Point{150,150}} };
-    vertical.set_color(Color_type::blue);
-    vertical.set_style(Style_type::solid, 2);
-    win.attach(horizontal);
-    win.attach(vertical);
-
-    Line diagonal { {Point{200,200},Point{250,250}} };
-    diagonal.set_color(Color_type::blue);
-    diagonal.set_style(Style_type::solid, 2);
-    win.attach(diagonal);
-    
-    Lines cross;
-    cross.add_line( {Point{300,300},Point{400,300}} );
-    cross.add_line( {Point{350,250},Point{350,350}} );
-    win.attach(cross);
-
+    
+    Scene scene{win.w(),win.h()};
+    lines_scene(scene);
+    scene.attach_to(win);
+    
     win.wait_for_button();
 }
 
@@ -88,20 +66,9 @@ void grid()
 {
     Simple_window win(Point{100,100},640,480,"Grid");
     
-    Lines grid;
-    int x_size = win.w();
-    int y_size = win.h();
-    int x_grid = 80;
-    int y_grid = 40;
-    for (int x=x_grid; x<x_size; x+=x_grid)
-        grid.add_line( {Point{x,0},Point{x,y_size}} );
-    for (int y=y_grid; y<y_size; y+=y_grid)
-        grid.add_line( {Point{0,y},Point{x_size,y}} );
-    
-    grid.set_color(Color_type::red);
-    grid.set_style(Style_type::dash, 4);
-    
-    win.attach(grid);
+    Scene scene{win.w(),win.h()};
+    grid_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -112,22 +79,9 @@ void polylines()
 {
     Simple_window win(Point{100,100},640,480,"Polylines and polygon");
     
-    Open_polyline open_poly = { Point{100,100}, Point{200,100},
-                                Point{150,50},  Point{150,150} };
-    open_poly.set_color(Color_type::magenta);
-    open_poly.set_style(Style_type::solid, 4);
-    win.attach(open_poly);
-    
-    Closed_polyline closed_poly = { Point{300,300}, Point{400,300},                                           Point{350,250}, Point{350,350} };
-    closed_poly.set_color(Color_type::green);
-    closed_poly.set_style(Style_type::solid, 4);
-    win.attach(closed_poly);
-    
-    Polygon poly = { Point{200,150},Point{250,25},
-                     Point{250,300}, Point{150,350} };
-    poly.set_color(Color_type::yellow);
-    poly.set_style(Style_type::solid, 4);
-    win.attach(poly);
+    Scene scene{win.w(),win.h()};
+    polylines_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -137,29 +91,16 @@ void rectangles()
 {
     Simple_window win(Point{100,100},640,480,"Rectangles 1");
     
-    Rectangle rect00{Point{150,100},200,100};
-    Rectangle rect11{Point{50,50},200,100};
-    Rectangle rect12{Point{50,150},200,100};
-    Rectangle rect21{Point{250,50},200,100};
-    Rectangle rect22{Point{250,150},200,100};
-    
-    rect00.set_color(Color_type::yellow);
-    rect11.set_color(Color_type::blue);
-    rect12.set_color(Color_type::red);
-    rect21.set_color(Color_type::green);
-    rect22.set_filled(false);
-    
-    win.attach(rect00);
-    win.attach(rect11);
-    win.attach(rect12);
-    win.attach(rect21);
-    win.attach(rect22);
+    Scene scene{win.w(),win.h()};
+    rectangles_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
     
     win.set_title("Rectangles 2");
     win.show();
     
+    Rectangle& rect11 = scene.get_shape<Rectangle>(1);
     rect11.set_color(Color_type::white);
     rect11.move(400,0);
     rect11.redraw();
@@ -167,17 +108,14 @@ void rectangles()
     win.wait_for_button();
     
     win.set_title("Rectangles 3");
-    win.put_on_top(rect00);
+    win.put_on_top(scene.get_shape<Rectangle>(0));
     
     win.wait_for_button();
     
     win.set_title("Rectangles 4");
     
-    rect00.set_outline(false);
-    rect11.set_outline(false);
-    rect12.set_outline(false);
-    rect21.set_outline(false);
-    rect22.set_outline(false);
+    for (size_t i=0; i<scene.get_nb_shapes(); i++)
+        scene.get_shape<Rectangle>(i).set_outline(false);
     
     win.wait_for_button();
 }
@@ -187,16 +125,10 @@ void colorgrid()
 {
     Simple_window win(Point{100,100},640,480,"16x16 color grid");
     
-    vector<Rectangle*> v;
-    
+    Scene scene{win.w(),win.h()};
     // shows a 16x16 color grid
-    for (int i=0; i<16; ++i)
-        for (int j=0; j<16; ++j)
-        {
-            v.push_back(new Rectangle{Point{i*20,j*20},20,20});
-            v[v.size()-1]->set_color((i*16+j));
-            win.attach(*v[v.size()-1]);
-        }
+    colorgrid_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -206,16 +138,9 @@ void text()
 {
     Simple_window win(Point{100,100},640,480,"Closed polyline with text");
     
-    Closed_polyline closed_poly = { Point{300,300}, Point{400,300},                                           Point{350,250}, Point{350,350} };
-    closed_poly.set_color(Color_type::green);
-    closed_poly.set_style(Style_type::solid, 4);
-    
-    Text t{Point{200,200}," A closed polyline that isn't a polygon"};
-    t.set_font(Font_type::times_bold_italic,18);
-    t.set_color(Color_type::blue);
-    
-    win.attach(closed_poly);
-    win.attach(t);
+    Scene scene{win.w(),win.h()};
+    text_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -225,13 +150,9 @@ void circles()
 {
     Simple_window win(Point{100,100},640,480,"Circles");
     
-    Circle c1{Point{100,200},50};
-    Circle c2{Point{150,200},100};
-    Circle c3{Point{200,200},150};
-    
-    win.attach(c1);
-    win.attach(c2);
-    win.attach(c3);
+    Scene scene{win.w(),win.h()};
+    circles_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -241,13 +162,9 @@ void ellipses()
 {
     Simple_window win(Point{100,100},640,480,"Ellipses");
     
-    Ellipse e1{Point{200,200},50,50};
-    Ellipse e2{Point{200,200},100,50};
-    Ellipse e3{Point{200,200},100,150};
-    
-    win.attach(e1);
-    win.attach(e2);
-    win.attach(e3);
+    Scene scene{win.w(),win.h()};
+    ellipses_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -257,21 +174,9 @@ void markedpolylines()
 {
     Simple_window win(Point{100,100},640,480,"Marked polylines");
     
-    Marked_polyline marked_poly{ {"one","two","three","four"}, {Point{100,100},Point{200,100}, Point{150,50}, Point{150,150}}};
-    marked_poly.set_color(Color_type::magenta);
-    marked_poly.set_style(Style_type::solid, 2);
-    marked_poly.set_font(Font_type::times_bold_italic,12);
-    win.attach(marked_poly);
-    
-    Marked_polyline marked_poly2{ {"{250,200}","{300,75}","{300,350}","{200,400}"} };
-    marked_poly2.add_point(Point{250,200});
-    marked_poly2.add_point(Point{300,75});
-    marked_poly2.add_point(Point{300,350});
-    marked_poly2.add_point(Point{200,400});
-    marked_poly2.set_color(Color_type::yellow);
-    marked_poly2.set_style(Style_type::solid, 4);
-    marked_poly2.set_font(Font_type::times_bold_italic,28);
-    win.attach(marked_poly2);
+    Scene scene{win.w(),win.h()};
+    markedpolylines_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -281,11 +186,9 @@ void marks()
 {
     Simple_window win(Point{100,100},640,480,"Marks");
     
-    Marks marks{"x",{Point{250,200},Point{300,75},Point{300,350},Point{200,400}}};
-    marks.set_color(Color_type::red);
-    marks.set_style(Style_type::solid, 4);
-    marks.set_font(Font_type::times_bold_italic,28);
-    win.attach(marks);
+    Scene scene{win.w(),win.h()};
+    marks_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -295,22 +198,9 @@ void circleswithmarks()
 {
     Simple_window win(Point{100,100},640,480,"Circles with centers");
     
-    Circle c1{Point{100,200},50};
-    Circle c2{Point{150,200},100};
-    Circle c3{Point{200,200},150};
-    c1.set_color(Color_type::blue);
-    c2.set_color(Color_type::red);
-    c3.set_color(Color_type::green);
-    win.attach(c1);
-    win.attach(c2);
-    win.attach(c3);
-    
-    Mark m1{Point{100,200},'x'};
-    Mark m2{Point{150,200},'y'};
-    Mark m3{Point{200,200},'z'};
-    win.attach(m1);
-    win.attach(m2);
-    win.attach(m3);
+    Scene scene{win.w(),win.h()};
+    circleswithmarks_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
@@ -320,15 +210,49 @@ void images()
 {
     Simple_window win(Point{100,100},640,480,"Images");
     
-    Image milky_way(Point{0,0},"MilkyWay.jpg");
-    milky_way.scale(win.w(),win.h());
-    Image moon(Point{0,0},"Moon.jpg");
-    moon.set_mask(Point{350,350},300,300);
+    // decoded in the background, drawn as a box until then
+    Scene scene{win.w(),win.h()};
+    images_scene(scene,Load_type::asynchronous);
+    scene.attach_to(win);
     
-    win.attach(milky_way);
-    win.attach(moon);
+    win.wait_for_button();
     
+    cout << "Image cache: " << Image_cache::instance().get_stats() << endl;
+}
+
+// example usage of the Tiled_image class
+void tiledimages()
+{
+    // the tile file is made once from a decoded image,
+    // large images would come tiled from their source
+    const string fn{"MilkyWay.tiles"};
+    if ( !filesystem::exists(fn) )
+    {
+        Fl_Shared_Image* img = Image_cache::instance().get("MilkyWay.jpg");
+        if ( (img->count() == 1) && (img->d() >= 3) )
+            Tiled_image::write_tiles(fn,reinterpret_cast<const uchar*>(img->data()[0]),
+                                     img->w(),img->h(),img->d(),img->ld(),128);
+        Image_cache::instance().release(img);
+    }
+    
+    Simple_window win(Point{100,100},640,480,"Tiled images");
+    
+    Tiled_image sky(Point{0,0},fn,640,480);
+    win.attach(sky);
+    
+    // every press of Next pans the view, only the
+    // tiles coming into view are read from the file
+    for (int i=0; i < 4; i++)
+    {
+        win.wait_for_button();
+        sky.pan(160,120);
+        sky.redraw();
+    }
     win.wait_for_button();
+    
+    Tiled_image_stats s = sky.get_stats();
+    cout << "Tiles: " << s.tiles_drawn << " drawn, " << s.tiles_prefetched
+         << " read ahead, " << s.tiles << " in the file" << endl;
 }
 
 // example usage of the Function, XAxis, and YAxis classes
@@ -336,49 +260,15 @@ void functions()
 {
     Simple_window win(Point{100,100},640,480,"Functions");
     
-    // constant
-    Function fg_1{[](double x){return 1;},{-2.0,2.0},0.001,{-2.0,2.0},
-        {320,240},200};
-    fg_1.add_label(-1.5,"1");
-    fg_1.set_color(Color_type::red);
-    
-    // line
-    Function fg_2{[](double x){return 2*x;},{-2.0,2.0},0.001,{-2.0,2.0},
-        {320,240},200};
-    fg_2.add_label(-1.0,"2x");
-    fg_2.set_color(Color_type::green);
-    
-    // parabola
-    Function fg_3{[](double x){return x*x;},{-2.0,2.0},0.001,{-2.0,2.0},
-        {320,240},200};
-    fg_3.add_label(-0.5,"x^2");
-    fg_3.set_color(Color_type::blue);
-    
-    // x axis
-    XAxis xaxis{{-2.0,2.0},1,Point{320,240},200};
-    xaxis.add_label(1.0,"1");
-    xaxis.set_color(Color_type::magenta);
-    
-    // y-axis
-    YAxis yaxis{{-2.0,2.0},1,Point{320,240},200};
-    yaxis.add_label(0,"O");
-    yaxis.add_label(1,"1");
-    yaxis.set_color(Color_type::magenta);
-    
-    win.attach(fg_1);
-    win.attach(fg_2);
-    win.attach(fg_3);
-    win.attach(xaxis);
-    win.attach(yaxis);
+    Scene scene{win.w(),win.h()};
+    functions_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
     
     // move the graphs around
-    fg_1.move(100,-50);
-    fg_2.move(100,-50);
-    fg_3.move(100,-50);
-    xaxis.move(100,-50);
-    yaxis.move(100,-50);
+    for (size_t i=0; i<scene.get_nb_shapes(); i++)
+        scene.get_shape<Shape>(i).move(100,-50);
     
     win.wait_for_button();
 }
@@ -388,36 +278,20 @@ void exponentials()
 {
     Simple_window win(Point{100,100},640,480,"Exponential functions");
     
-    Function e_gr{[](double x){return exp(x);},{-8.0,8.0},0.001,{-8.0,8.0},
-        {320,240},400};
-    e_gr.set_color(Color_type::red);
-    e_gr.add_label(2,"e^x");
-    
-    // x axis
-    XAxis xaxis{{-8.0,8.0},1,Point{320,240},400};
-    xaxis.add_label(1.0,"1");
-    xaxis.set_color(Color_type::magenta);
-    
-    // y-axis
-    YAxis yaxis{{-8.0,8.0},1,Point{320,240},400};
-    yaxis.add_label(0,"O");
-    yaxis.add_label(1,"1");
-    yaxis.set_color(Color_type::magenta);
-    
-    win.attach(e_gr);
-    win.attach(xaxis);
-    win.attach(yaxis);
+    Scene scene{win.w(),win.h()};
+    exponentials_scene(scene);
+    scene.attach_to(win);
     
     for (int n=0; n<10; n++) {
         ostringstream ss;
         ss << "exponential approx n= " << n;
         string t{ss.str()};
         win.set_title(t);
-        Function ee_gr{[n](double x){return expe(x,n);},{-8.0,8.0},0.001,{-8.0,8.0},
-            {320,240},400};
-        win.attach(ee_gr);
+        Scene approx{win.w(),win.h()};
+        exponential_approx_scene(approx,n);
+        approx.attach_to(win);
         win.wait_for_button();
-        win.detach(ee_gr);
+        approx.detach_from(win);
     }
 }
 
@@ -426,66 +300,43 @@ void dataplots()
 {
     Simple_window win(Point{100,100},640,480,"Data");
     
-    // x axis
-    XAxis xaxis{{2000,2009},1,Point{100,430},400};
-    xaxis.add_label(2000,"2000",0,20);
-    xaxis.add_label(2005,"2005",0,20);
-    xaxis.add_label(2009,"2009",0,20);
-    xaxis.set_color(Color_type::black);
-    Text tx{Point{120,470},"Years"};
-    
-    // y axis
-    YAxis yaxis{{0,100},10,Point{100,430},400};
-    yaxis.add_label(0,"0%",-40,0);
-    yaxis.add_label(50,"50%",-40,0);
-    yaxis.add_label(100,"100%",-40,0);
-    yaxis.set_color(Color_type::black);
-    Text ty{Point{40,90},"Growth"};
-    
-    // data set 1
-    Open_polyline poly1;
-    vector<Point> ds_1 = {Point{2001,78}, Point{2002,70}, Point{2003,83},
-                          Point{2004,75}, Point{2005,70}, Point{2006,72},
-                          Point{2007,75}, Point{2008,77}, Point{2009,87} };
-    for (auto p:ds_1) poly1.add_point(Point{xaxis.pos(p.x),yaxis.pos(p.y)});
-    poly1.set_color(Color_type::red);
-    Text tds_1{Point{xaxis.pos(2001),yaxis.pos(78)-30},"Dataset 1"};
-    tds_1.set_color(Color_type::red);
-    
-    // data set 2
-    Open_polyline poly2;
-    vector<Point> ds_2 = {Point{2001,41}, Point{2002,50}, Point{2003,38},
-                          Point{2004,51}, Point{2005,43}, Point{2006,52},
-                          Point{2007,33}, Point{2008,44}, Point{2009,61} };
-    for (auto p:ds_2) poly2.add_point(Point{xaxis.pos(p.x),yaxis.pos(p.y)});
-    poly2.set_color(Color_type::yellow);
-    Text tds_2{Point{xaxis.pos(2001),yaxis.pos(41)-50},"Dataset 2"};
-    tds_2.set_color(Color_type::yellow);
-    
-    // data set 3
-    Open_polyline poly3;
-    vector<Point> ds_3 = {Point{2001,22}, Point{2002,14}, Point{2003,32},
-                          Point{2004,21}, Point{2005,23}, Point{2006,27},
-                          Point{2007,13}, Point{2008,20}, Point{2009,22} };
-    for (auto p:ds_3) poly3.add_point(Point{xaxis.pos(p.x),yaxis.pos(p.y)});
-    poly3.set_color(Color_type::blue);
-    Text tds_3{Point{xaxis.pos(2001),yaxis.pos(22)-30},"Dataset 3"};
-    tds_3.set_color(Color_type::blue);
-    
-    win.attach(tx);
-    win.attach(ty);
-    win.attach(tds_1);
-    win.attach(tds_2);
-    win.attach(tds_3);
-    win.attach(poly1);
-    win.attach(poly2);
-    win.attach(poly3);
-    win.attach(xaxis);
-    win.attach(yaxis);
+    Scene scene{win.w(),win.h()};
+    dataplots_scene(scene);
+    scene.attach_to(win);
     
     win.wait_for_button();
 }
 
+// example of data produced by another thread
+void livedata()
+{
+    Simple_window win(Point{100,100},640,480,"Live data");
+    
+    Open_polyline signal;
+    signal.set_color(Color_type::blue);
+    win.attach(signal);
+    win.show();
+    
+    // the acquisition thread never touches the shapes,
+    // its points are added by the UI thread in batches
+    Mutation_queue queue;
+    atomic<bool> stop{false};
+    thread acquisition{[&] {
+        for (int i=0; (i < 10000) && !stop; i++)
+        {
+            Point p{50+i/20,240+int(150*sin(i/300.0)*cos(i/37.0))};
+            queue.push(signal,[&signal,p] { signal.add_point(p); });
+            this_thread::sleep_for(chrono::microseconds(500));
+        }
+    }};
+    
+    win.wait_for_button();
+    stop = true;
+    acquisition.join();
+    
+    cout << "Mutation queue: " << queue.get_stats() << endl;
+}
+
 // example usage of a button
 void buttons()
 {
@@ -511,19 +362,97 @@ void inoutbox()
     win.attach(in_box);
     win.attach(out_box);
     
-    for(;;) {
+    win.redraw();
+    win.show();
+    
+    // sleeps until the text changes or Next is pressed
+    while ( win.wait_for_input_change(in_box) ) {
         string input_text = in_box.get_input_text();
-        if ( (input_text == string{"quit"}) ||
-             win.is_button_pressed() )
+        if (input_text == string{"quit"})
             break;
         out_box.set_output_text(input_text);
         win.redraw();
-        win.show();
     }
     
     win.hide();
 }
 
+// script of the first window of scripts(): a rectangle
+// moves every half second, then waits for Next
+static Script moving_rectangle()
+{
+    Simple_window win(Point{100,100},640,480,"Script 1");
+    
+    Rectangle rect{Point{50,200},100,100};
+    rect.set_color(Color_type::blue);
+    win.attach(rect);
+    win.show();
+    
+    for (int i=0; i < 10; i++) {
+        co_await win.timeout(500);
+        rect.move(40,0);
+        win.redraw();
+    }
+    co_await win.next_pressed();
+}
+
+// script of the second window of scripts(): the input
+// text is echoed until it is quit
+static Script echo_box()
+{
+    Simple_window win(Point{760,100},640,480,"Script 2");
+    
+    In_box in_box{Point{100,100},100,50,"input:"};
+    Out_box out_box{Point{200,300},100,50,"output:"};
+    win.attach(in_box);
+    win.attach(out_box);
+    win.show();
+    
+    while (in_box.get_input_text() != string{"quit"}) {
+        co_await in_box.changed();
+        out_box.set_output_text(in_box.get_input_text());
+        win.redraw();
+    }
+}
+
+// example of two windows driven by scripts at the same time
+void scripts()
+{
+    vector<Script> s;
+    s.push_back(moving_rectangle());
+    s.push_back(echo_box());
+    run_scripts(s);
+}
+
+// example usage of the Animator class
+void animations()
+{
+    Simple_window win(Point{100,100},640,480,"Animations");
+    
+    Rectangle rect{Point{50,50},100,100};
+    rect.set_color(Color_type::blue);
+    Circle circle{Point{320,240},80};
+    circle.set_color(Color_type::red);
+    circle.set_style(Style_type::solid,10);
+    
+    win.attach(rect);
+    win.attach(circle);
+    win.show();
+    
+    // the tweens run together, one redraw per frame
+    Animator anim{60};
+    anim.move_to(rect,Point{450,300},2,Easing_type::ease_in_out,[&] {
+        anim.color_to(rect,FL_GREEN,1);
+    });
+    anim.alpha_to(circle,64,3);
+    anim.tween(circle,80,160,3,[&circle](double r) { circle.set_radius(int(r)); });
+    anim.wait();
+    
+    cout << "Animator: " << anim.get_stats() << endl;
+    
+    win.wait_for_button();
+}
+
 // example usage of a menu
 void menu()
 {
@@ -558,3 +487,45 @@ void lineswindow()
     win.wait_for_button();
 }
 
+// example usage of the Scene and Batch_renderer classes:
+// charts in the style of dataplots() are written to files
+// without any window, spread over all the cores
+void batchexport()
+{
+    Batch_renderer batch{640,480};
+    filesystem::create_directories("charts");
+    
+    for (int n=0; n<64; n++) {
+        ostringstream fn;
+        fn << "charts/chart" << n << ".png";
+        batch.add(fn.str(),[n](Scene& scene) {
+            scene.set_antialias(true);
+            
+            // x axis
+            XAxis& xaxis = scene.add(new XAxis{{2000,2009},1,Point{100,430},400});
+            xaxis.add_label(2000,"2000",0,20);
+            xaxis.add_label(2009,"2009",0,20);
+            xaxis.set_color(Color_type::black);
+            
+            // y axis
+            YAxis& yaxis = scene.add(new YAxis{{0,100},10,Point{100,430},400});
+            yaxis.add_label(0,"0%",-40,0);
+            yaxis.add_label(100,"100%",-40,0);
+            yaxis.set_color(Color_type::black);
+            
+            // data set, a different one for every chart
+            Open_polyline& poly = scene.add(new Open_polyline);
+            for (int year=2001; year<=2009; year++)
+                poly.add_point(Point{xaxis.pos(year),
+                    yaxis.pos(50+40*sin(0.7*year+n))});
+            poly.set_color(Color_type::red);
+            poly.set_style(Style_type::solid,2);
+            
+            Text& title = scene.add(new Text{Point{100,40},"Chart " + to_string(n)});
+            title.set_font(Font_type::helvetica_bold,20);
+        });
+    }
+    
+    Batch_report report = batch.run();
+    cout << "Batch export: " << report << endl;
+}
@@ -69,6 +69,9 @@ void circleswithmarks();
 // example usage of the Image class
 void images();
 
+// example usage of the Tiled_image class
+void tiledimages();
+
 // example usage of the Function, XAxis, and YAxis classes
 void functions();
 
@@ -78,16 +81,28 @@ void exponentials();
 // example usage of polylines for representing data
 void dataplots();
 
+// example of shapes changed by another thread
+void livedata();
+
 // example usage of a button
 void buttons();
 
 // example usage of an input and output box
 void inoutbox();
 
+// example of windows driven by coroutines
+void scripts();
+
+// example usage of the Animator class
+void animations();
+
 // example of an application
 void lineswindow();
 
 // example of a menu
 void menu();
 
+// example of charts rendered to files without a window
+void batchexport();
+
 #endif /* examples_h */
@@ -30,13 +30,50 @@
 */
 
 #include "examples.h"
+#include "Counters.hpp"
+#include "Draw_profiler.hpp"
+#include "Image_cache.hpp"
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 int main(int argc, char **argv)
 {
     try
     {
+        // options: --disk-cache DIR keeps decoded images on disk for
+        // the next runs, --profile FILE writes the draw times at exit,
+        // --counters prints the hidden work per window at exit
+        static std::string profile;
+        for (int i=1; i < argc; i++)
+        {
+            std::string opt{argv[i]};
+            if (opt == "--counters")
+            {
+                mathsophy::graphics::Counters::enable(true);
+                // closing a window ends the program with exit()
+                mathsophy::graphics::Counters::instance();
+                std::atexit([] {
+                    mathsophy::graphics::Counters::instance().print(std::cerr);
+                });
+            }
+            else if ( (opt == "--disk-cache") && (i+1 < argc) )
+                mathsophy::graphics::Image_cache::instance().set_disk_cache(argv[++i]);
+            else if ( (opt == "--profile") && (i+1 < argc) )
+            {
+                profile = argv[++i];
+                mathsophy::graphics::Draw_profiler::instance().enable(true);
+                std::atexit([] {
+                    try {
+                        mathsophy::graphics::Draw_profiler::instance().write(profile);
+                    } catch (std::runtime_error& e) {
+                        std::cerr << "Exception: " << e.what() << std::endl;
+                    }
+                });
+            }
+        }
+        
         lines();
         grid();
         polylines();
@@ -49,13 +86,18 @@ int main(int argc, char **argv)
         marks();
         circleswithmarks();
         images();
+        tiledimages();
         functions();
         exponentials();
         dataplots();
+        livedata();
         buttons();
         inoutbox();
+        scripts();
+        animations();
         menu();
         lineswindow();
+        batchexport();
     } catch (std::runtime_error& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
         return 1;